@@ -0,0 +1,335 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Benchmark.hxx"
+
+#include <direct.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+BENCHMARK Benchmark;
+
+// NOTE: Xorshift, so that the same seed produces the same archive and the same access pattern on any machine.
+unsigned AcquireBenchmarkRandom(void)
+{
+    Benchmark.Random ^= Benchmark.Random << 13;
+    Benchmark.Random ^= Benchmark.Random >> 17;
+    Benchmark.Random ^= Benchmark.Random << 5;
+
+    return Benchmark.Random;
+}
+
+unsigned AcquireBenchmarkFileSize(void)
+{
+    switch (Benchmark.Distribution)
+    {
+    case BENCHMARKDISTRIBUTION_UNIFORM: { return 1 + AcquireBenchmarkRandom() % (2 * Benchmark.Size); }
+    case BENCHMARKDISTRIBUTION_EXPONENTIAL:
+    {
+        const double value = (AcquireBenchmarkRandom() >> 8) / (double)(1 << 24);
+        const double size = -log(1.0 - value) * Benchmark.Size;
+
+        return (unsigned)max(1.0, min(size, (double)Benchmark.Size * MAX_BENCHMARK_FILE_SIZE_MULTIPLIER));
+    }
+    }
+
+    return Benchmark.Size;
+}
+
+// NOTE: Letters drawn from a 32-character alphabet, so that the content compresses to about two thirds, like the game data.
+void AcquireBenchmarkFileContent(void* content, const unsigned size)
+{
+    for (unsigned i = 0; i < size; i++) { ((char*)content)[i] = (char)('@' + ((AcquireBenchmarkRandom() >> 16) & 0x1F)); }
+}
+
+double AcquireBenchmarkTime(void)
+{
+    LARGE_INTEGER value;
+    QueryPerformanceCounter(&value);
+
+    return (double)value.QuadPart / (double)Benchmark.Frequency.QuadPart;
+}
+
+const char* AcquireBenchmarkDistributionName(const BENCHMARKDISTRIBUTION distribution)
+{
+    switch (distribution)
+    {
+    case BENCHMARKDISTRIBUTION_UNIFORM: { return "uniform"; }
+    case BENCHMARKDISTRIBUTION_EXPONENTIAL: { return "exponential"; }
+    }
+
+    return "fixed";
+}
+
+void InitializeBenchmarkNames(void)
+{
+    Benchmark.Names = (char*)malloc(Benchmark.Count * MAX_BENCHMARK_NAME_LENGTH);
+    Benchmark.Misses = (char*)malloc(Benchmark.Count * MAX_BENCHMARK_NAME_LENGTH);
+
+    for (unsigned i = 0; i < Benchmark.Count; i++)
+    {
+        sprintf(&Benchmark.Names[i * MAX_BENCHMARK_NAME_LENGTH], "dir%04u\\file%06u.bin", i / BENCHMARK_FILES_PER_DIRECTORY, i);
+        sprintf(&Benchmark.Misses[i * MAX_BENCHMARK_NAME_LENGTH], "dir%04u\\miss%06u.bin", i / BENCHMARK_FILES_PER_DIRECTORY, i);
+    }
+}
+
+void ReleaseBenchmarkNames(void)
+{
+    free(Benchmark.Names);
+    free(Benchmark.Misses);
+
+    Benchmark.Names = NULL;
+    Benchmark.Misses = NULL;
+}
+
+// NOTE:
+// Each scenario starts with an empty chunk cache, so that the results do not depend on the order they run in.
+// The buffer sizes of the mounted archives are kept, so that the chunks are still recycled from the pool.
+void ResetBenchmarkCache(void)
+{
+    const unsigned buffer = State.Chunks.BufferSize;
+    const unsigned input = State.Chunks.InputSize;
+
+    ReleaseArchiveItemChunks();
+    InitializeArchiveItemChunks();
+
+    State.Chunks.BufferSize = buffer;
+    State.Chunks.InputSize = input;
+
+    if (State.ReadAhead.ChunkCount != 0) { InitializeReadAhead(); }
+}
+
+BENCHMARKRESULTPTR AcquireBenchmarkResult(const char* name)
+{
+    BENCHMARKRESULTPTR result = &Benchmark.Results[Benchmark.ResultCount];
+
+    Benchmark.ResultCount = Benchmark.ResultCount + 1;
+
+    result->Name = name;
+    result->Operations = 0;
+    result->Bytes = 0;
+    result->Seconds = 0;
+    result->Hits = 0;
+    result->Misses = 0;
+    result->Evictions = 0;
+
+    return result;
+}
+
+void CompleteBenchmarkResult(BENCHMARKRESULTPTR result, const double seconds)
+{
+    result->Seconds = seconds;
+
+    result->Hits = State.Chunks.Hits;
+    result->Misses = State.Chunks.Misses;
+    result->Evictions = State.Chunks.Evictions;
+}
+
+bool BenchmarkArchiveOpen(const char* path)
+{
+    BENCHMARKRESULTPTR result = AcquireBenchmarkResult("open");
+
+    double seconds = 0;
+
+    for (unsigned i = 0; i < DEFAULT_BENCHMARK_OPEN_COUNT; i++)
+    {
+        ReleaseArchiveItemChunks();
+        ReleaseArchives();
+
+        Initialize();
+
+        const double start = AcquireBenchmarkTime();
+
+        if (!OpenArchive(path, 0)) { return false; }
+
+        seconds = seconds + AcquireBenchmarkTime() - start;
+    }
+
+    result->Operations = DEFAULT_BENCHMARK_OPEN_COUNT;
+
+    CompleteBenchmarkResult(result, seconds);
+
+    return true;
+}
+
+void BenchmarkArchiveItemLookup(const bool hit)
+{
+    BENCHMARKRESULTPTR result = AcquireBenchmarkResult(hit ? "lookup-hit" : "lookup-miss");
+
+    const char* names = hit ? Benchmark.Names : Benchmark.Misses;
+
+    unsigned found = 0;
+
+    const double start = AcquireBenchmarkTime();
+
+    for (unsigned i = 0; i < Benchmark.Iterations; i++)
+    {
+        const int indx = AcquireArchiveItemIndex(&names[(i % Benchmark.Count) * MAX_BENCHMARK_NAME_LENGTH]);
+
+        if (indx != INVALID_ARCHIVE_ITEM_INDEX) { found = found + 1; }
+    }
+
+    CompleteBenchmarkResult(result, AcquireBenchmarkTime() - start);
+
+    result->Operations = Benchmark.Iterations;
+
+    if (found != (hit ? Benchmark.Iterations : 0)) { fprintf(stderr, "Warning: %u of %u lookups found an item\n", found, Benchmark.Iterations); }
+}
+
+void BenchmarkSequentialRead(void)
+{
+    ResetBenchmarkCache();
+
+    BENCHMARKRESULTPTR result = AcquireBenchmarkResult("read-sequential");
+
+    void* buffer = malloc(BENCHMARK_BUFFER_SIZE);
+
+    const double start = AcquireBenchmarkTime();
+
+    for (unsigned i = 0; i < Benchmark.Count; i++)
+    {
+        Content content;
+
+        if (!content.Open(&Benchmark.Names[i * MAX_BENCHMARK_NAME_LENGTH])) { continue; }
+
+        while (true)
+        {
+            const unsigned length = content.Read(buffer, BENCHMARK_BUFFER_SIZE);
+
+            if (length == 0) { break; }
+
+            result->Operations = result->Operations + 1;
+            result->Bytes = result->Bytes + length;
+        }
+
+        content.Close();
+    }
+
+    CompleteBenchmarkResult(result, AcquireBenchmarkTime() - start);
+
+    free(buffer);
+}
+
+void BenchmarkRandomRead(void)
+{
+    ResetBenchmarkCache();
+
+    BENCHMARKRESULTPTR result = AcquireBenchmarkResult("read-random");
+
+    byte buffer[BENCHMARK_READ_SIZE];
+
+    const double start = AcquireBenchmarkTime();
+
+    for (unsigned i = 0; i < Benchmark.Iterations; i++)
+    {
+        Content content;
+
+        if (!content.Open(&Benchmark.Names[(AcquireBenchmarkRandom() % Benchmark.Count) * MAX_BENCHMARK_NAME_LENGTH])) { continue; }
+
+        const unsigned long long offset = AcquireBenchmarkRandom() % content.Size();
+
+        result->Operations = result->Operations + 1;
+        result->Bytes = result->Bytes + content.ReadAt(offset, buffer, BENCHMARK_READ_SIZE);
+
+        content.Close();
+    }
+
+    CompleteBenchmarkResult(result, AcquireBenchmarkTime() - start);
+}
+
+bool BenchmarkExtraction(const char* root)
+{
+    ResetBenchmarkCache();
+
+    BENCHMARKRESULTPTR result = AcquireBenchmarkResult("extract");
+
+    mkdir(root);
+
+    const double start = AcquireBenchmarkTime();
+
+    unsigned count = 0;
+    int* order = AcquireArchiveItemOrder(&count);
+
+    InitializeExtractionDirectories(MIN_EXTRACTION_DIRECTORY_COUNT);
+    InitializeArchiveItemDirectories(root, order, count);
+
+    bool success = true;
+
+    if (State.ThreadCount > 1) { success = ExtractArchiveItems(root, State.ThreadCount, order, count); }
+    else
+    {
+        for (unsigned i = 0; i < count && success; i++) { success = ExtractArchiveItem(root, order[i]); }
+    }
+
+    ReleaseExtractionDirectories();
+
+    CompleteBenchmarkResult(result, AcquireBenchmarkTime() - start);
+
+    free(order);
+
+    result->Operations = count;
+    result->Bytes = Benchmark.Bytes;
+
+    return success;
+}
+
+void SaveBenchmarkResults(const char* path)
+{
+    FILE* file = path == NULL ? stdout : fopen(path, "wb");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "Cannot write %s\n", path);
+
+        return;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"files\": %u,\n", Benchmark.Count);
+    fprintf(file, "  \"size\": %u,\n", Benchmark.Size);
+    fprintf(file, "  \"distribution\": \"%s\",\n", AcquireBenchmarkDistributionName(Benchmark.Distribution));
+    fprintf(file, "  \"bytes\": %llu,\n", Benchmark.Bytes);
+    fprintf(file, "  \"block\": %u,\n", Benchmark.Block);
+    fprintf(file, "  \"level\": %d,\n", Benchmark.Level);
+    fprintf(file, "  \"iterations\": %u,\n", Benchmark.Iterations);
+    fprintf(file, "  \"threads\": %u,\n", max(1, State.ThreadCount));
+    fprintf(file, "  \"cache\": %u,\n", State.Chunks.Capacity);
+    fprintf(file, "  \"results\": [\n");
+
+    for (unsigned i = 0; i < Benchmark.ResultCount; i++)
+    {
+        BENCHMARKRESULTPTR result = &Benchmark.Results[i];
+
+        const double nanoseconds = result->Operations == 0 ? 0 : result->Seconds * 1e9 / result->Operations;
+        const double megabytes = result->Seconds == 0 ? 0 : result->Bytes / result->Seconds / (1024.0 * 1024.0);
+
+        fprintf(file, "    { \"name\": \"%s\", \"operations\": %llu, \"bytes\": %llu, \"seconds\": %.6f, \"nanosecondsPerOperation\": %.1f, \"megabytesPerSecond\": %.2f, \"hits\": %u, \"misses\": %u, \"evictions\": %u }%s\n",
+            result->Name, result->Operations, result->Bytes, result->Seconds, nanoseconds, megabytes,
+            result->Hits, result->Misses, result->Evictions, i + 1 < Benchmark.ResultCount ? "," : "");
+    }
+
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+
+    if (file != stdout) { fclose(file); }
+}
\ No newline at end of file
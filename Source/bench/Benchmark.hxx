@@ -0,0 +1,112 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../unsue/Content.hxx"
+#include "../unsue/State.hxx"
+
+#define DEFAULT_BENCHMARK_FILE_COUNT        1000
+#define DEFAULT_BENCHMARK_FILE_SIZE         65536
+#define DEFAULT_BENCHMARK_BLOCK_SIZE        16384
+#define DEFAULT_BENCHMARK_LEVEL             9
+#define DEFAULT_BENCHMARK_ITERATION_COUNT   100000
+#define DEFAULT_BENCHMARK_OPEN_COUNT        16
+#define DEFAULT_BENCHMARK_SEED              0x5EED
+
+#define MAX_BENCHMARK_FILE_SIZE_MULTIPLIER  64
+#define MAX_BENCHMARK_NAME_LENGTH           32
+#define MAX_BENCHMARK_RESULT_COUNT          16
+#define MAX_BENCHMARK_COMMAND_LENGTH        (4 * MAX_PATH)
+
+#define BENCHMARK_FILES_PER_DIRECTORY       64
+#define BENCHMARK_READ_SIZE                 4096
+#define BENCHMARK_BUFFER_SIZE               (64 * 1024)
+#define BENCHMARK_FILES_EXTENSION           ".files"
+#define BENCHMARK_PACKER_NAME               "sue.exe"
+
+typedef enum BenchmarkDistribution
+{
+    BENCHMARKDISTRIBUTION_FIXED         = 0, // All the files are of the same size
+    BENCHMARKDISTRIBUTION_UNIFORM       = 1, // Uniform between 1 byte and twice the size
+    BENCHMARKDISTRIBUTION_EXPONENTIAL   = 2, // Mostly small files, with a long tail of large ones
+    BENCHMARKDISTRIBUTION_FORCE_DWORD   = 0x7FFFFFFF
+} BENCHMARKDISTRIBUTION, * BENCHMARKDISTRIBUTIONPTR;
+
+typedef struct BenchmarkResult
+{
+    const char*                 Name;
+    unsigned long long          Operations;
+    unsigned long long          Bytes;
+    double                      Seconds;
+
+    // The chunk cache counters of the scenario.
+    unsigned                    Hits;
+    unsigned                    Misses;
+    unsigned                    Evictions;
+} BENCHMARKRESULT, * BENCHMARKRESULTPTR;
+
+typedef struct Benchmark
+{
+    unsigned                    Count;
+    unsigned                    Size;
+    BENCHMARKDISTRIBUTION       Distribution;
+    unsigned                    Block;
+    int                         Level;
+    unsigned                    Iterations;
+    unsigned                    Random;     // The state of the generator, seeded from the command line.
+
+    const char*                 Packer;     // The sue executable that packs the archive.
+    const char*                 Options;    // The additional switches of the packer.
+
+    LARGE_INTEGER               Frequency;
+
+    char*                       Names;      // The names of the generated files.
+    char*                       Misses;     // The names that are not in the archive.
+    unsigned long long          Bytes;      // The total size of the generated files.
+
+    unsigned                    ResultCount;
+    BENCHMARKRESULT             Results[MAX_BENCHMARK_RESULT_COUNT];
+} BENCHMARK, * BENCHMARKPTR;
+
+extern BENCHMARK Benchmark;
+
+unsigned AcquireBenchmarkRandom(void);
+unsigned AcquireBenchmarkFileSize(void);
+void AcquireBenchmarkFileContent(void* content, const unsigned size);
+double AcquireBenchmarkTime(void);
+const char* AcquireBenchmarkDistributionName(const BENCHMARKDISTRIBUTION distribution);
+
+void InitializeBenchmarkNames(void);
+void ReleaseBenchmarkNames(void);
+void ResetBenchmarkCache(void);
+BENCHMARKRESULTPTR AcquireBenchmarkResult(const char* name);
+void CompleteBenchmarkResult(BENCHMARKRESULTPTR result, const double seconds);
+
+bool GenerateBenchmarkFiles(const char* root);
+bool GenerateArchive(const char* path);
+bool BenchmarkArchiveOpen(const char* path);
+void BenchmarkArchiveItemLookup(const bool hit);
+void BenchmarkSequentialRead(void);
+void BenchmarkRandomRead(void);
+bool BenchmarkExtraction(const char* root);
+void SaveBenchmarkResults(const char* path);
\ No newline at end of file
@@ -0,0 +1,138 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Benchmark.hxx"
+
+#include <direct.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// NOTE:
+// The files are written in the same order as the names, a directory per BENCHMARK_FILES_PER_DIRECTORY files,
+// so that the packed archive holds the names the other scenarios look up.
+bool GenerateBenchmarkFiles(const char* root)
+{
+    mkdir(root);
+
+    void* content = NULL;
+    unsigned capacity = 0;
+
+    for (unsigned i = 0; i < Benchmark.Count; i++)
+    {
+        char path[MAX_PATH];
+
+        if (i % BENCHMARK_FILES_PER_DIRECTORY == 0)
+        {
+            sprintf(path, "%s\\dir%04u", root, i / BENCHMARK_FILES_PER_DIRECTORY);
+            mkdir(path);
+        }
+
+        sprintf(path, "%s\\%s", root, &Benchmark.Names[i * MAX_BENCHMARK_NAME_LENGTH]);
+
+        const unsigned size = AcquireBenchmarkFileSize();
+
+        if (capacity < size)
+        {
+            capacity = size;
+            content = realloc(content, capacity);
+        }
+
+        AcquireBenchmarkFileContent(content, size);
+
+        FILE* file = fopen(path, "wb");
+
+        if (file == NULL)
+        {
+            fprintf(stderr, "Cannot write %s\n", path);
+
+            free(content);
+
+            return false;
+        }
+
+        fwrite(content, 1, size, file);
+        fclose(file);
+
+        Benchmark.Bytes = Benchmark.Bytes + size;
+    }
+
+    free(content);
+
+    return true;
+}
+
+// NOTE:
+// The archive is packed by the actual sue executable, so that its whole code path is measured,
+// only the run of the packer is timed, not the generation of the files it packs.
+bool GenerateArchive(const char* path)
+{
+    char root[MAX_PATH];
+    sprintf(root, "%s%s", path, BENCHMARK_FILES_EXTENSION);
+
+    if (!GenerateBenchmarkFiles(root)) { return false; }
+
+    BENCHMARKRESULTPTR result = AcquireBenchmarkResult("pack");
+
+    // NOTE: The trailing backslash of the directory is doubled, so that it does not escape the closing quote.
+    char command[MAX_BENCHMARK_COMMAND_LENGTH];
+    sprintf(command, "\"%s\" -q -m%d -b%u %s \"%s\" \"%s\\\\\"",
+        Benchmark.Packer, Benchmark.Level, Benchmark.Block, Benchmark.Options == NULL ? "" : Benchmark.Options, path, root);
+
+    STARTUPINFOA startup;
+    ZeroMemory(&startup, sizeof(STARTUPINFOA));
+    startup.cb = sizeof(STARTUPINFOA);
+
+    PROCESS_INFORMATION process;
+
+    const double start = AcquireBenchmarkTime();
+
+    if (!CreateProcessA(NULL, command, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &process))
+    {
+        fprintf(stderr, "Cannot run %s\n", Benchmark.Packer);
+
+        return false;
+    }
+
+    WaitForSingleObject(process.hProcess, INFINITE);
+
+    const double seconds = AcquireBenchmarkTime() - start;
+
+    DWORD code = EXIT_FAILURE;
+    GetExitCodeProcess(process.hProcess, &code);
+
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+
+    if (code != EXIT_SUCCESS)
+    {
+        fprintf(stderr, "Cannot pack %s, %s exited with %u\n", path, Benchmark.Packer, (unsigned)code);
+
+        return false;
+    }
+
+    result->Operations = Benchmark.Count;
+    result->Bytes = Benchmark.Bytes;
+
+    CompleteBenchmarkResult(result, seconds);
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Benchmark.hxx"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char* argv[])
+{
+    Benchmark.Count = DEFAULT_BENCHMARK_FILE_COUNT;
+    Benchmark.Size = DEFAULT_BENCHMARK_FILE_SIZE;
+    Benchmark.Distribution = BENCHMARKDISTRIBUTION_FIXED;
+    Benchmark.Block = DEFAULT_BENCHMARK_BLOCK_SIZE;
+    Benchmark.Level = DEFAULT_BENCHMARK_LEVEL;
+    Benchmark.Iterations = DEFAULT_BENCHMARK_ITERATION_COUNT;
+    Benchmark.Random = DEFAULT_BENCHMARK_SEED;
+
+    QueryPerformanceFrequency(&Benchmark.Frequency);
+
+    State.IsSilent = true;
+
+    // The packer is expected next to the benchmark, unless told otherwise.
+    char packer[MAX_PATH];
+
+    {
+        GetModuleFileNameA(NULL, packer, MAX_PATH);
+
+        char* end = strrchr(packer, '\\');
+
+        strcpy(end == NULL ? packer : end + 1, BENCHMARK_PACKER_NAME);
+    }
+
+    Benchmark.Packer = packer;
+
+    const char* output = NULL;
+
+    int x = 1;
+
+    {
+        while (x < argc)
+        {
+            const char* param = argv[x];
+
+            if (param[0] != '-') { break; }
+            else if (param[1] == 'n') { Benchmark.Count = max(1, atoi(&param[2])); }
+            else if (param[1] == 's') { Benchmark.Size = max(1, atoi(&param[2])); }
+            else if (param[1] == 'b') { Benchmark.Block = max(0, atoi(&param[2])); }
+            else if (param[1] == 'm') { Benchmark.Level = min(Z_BEST_COMPRESSION, max(Z_NO_COMPRESSION, atoi(&param[2]))); }
+            else if (param[1] == 'i') { Benchmark.Iterations = max(1, atoi(&param[2])); }
+            else if (param[1] == 'x') { Benchmark.Random = max(1, strtoul(&param[2], NULL, 10)); }
+            else if (param[1] == 'o') { output = &param[2]; }
+            else if (param[1] == 'e') { Benchmark.Packer = &param[2]; }
+            else if (param[1] == 'f') { Benchmark.Options = &param[2]; }
+            else if (param[1] == 'p') { State.IsMapped = true; }
+            else if (param[1] == 'c') { State.Chunks.Capacity = strtoul(&param[2], NULL, 10); }
+            else if (param[1] == 'r')
+            {
+                State.ReadAhead.ChunkCount = min(atoi(&param[2]), MAX_READ_AHEAD_CHUNK_COUNT);
+            }
+            else if (param[1] == 'j')
+            {
+                State.ThreadCount = min(max(1, atoi(&param[2])), MAX_EXTRACTION_THREAD_COUNT);
+            }
+            else if (param[1] == 'd')
+            {
+                if (_strcmpi(&param[2], "fixed") == 0) { Benchmark.Distribution = BENCHMARKDISTRIBUTION_FIXED; }
+                else if (_strcmpi(&param[2], "uniform") == 0) { Benchmark.Distribution = BENCHMARKDISTRIBUTION_UNIFORM; }
+                else if (_strcmpi(&param[2], "exponential") == 0) { Benchmark.Distribution = BENCHMARKDISTRIBUTION_EXPONENTIAL; }
+                else { x = argc; }
+            }
+            else { x = argc; }
+
+            x = x + 1;
+        }
+
+        if (argc - x < 1)
+        {
+            printf("Syntax: %s [switches] file.sue [outdir]\n-n<n>      Number of files=<n>, default=1000\n-s<nnn>    File size=<nnn> bytes, default=65536\n-d<dist>   File size distribution=<dist>, fixed(default), uniform or exponential\n-b<nnn>    Compression block size=<nnn>, default=16384\n-m<n>      Compression level=<n>, 0-no compression, 1-fast, 9-best(default)\n-i<n>      Number of lookups and random reads=<n>, default=100000\n-x<n>      Random seed=<n>, the same seed generates the same archive\n-j<n>      Extract with <n> threads, default=1\n-c<nnn>    Chunk cache size=<nnn> bytes, default=4194304\n-r<n>      Read <n> chunks of compressed files ahead on a background thread\n-p         Memory-map the archive file\n-o<file>   Write the results to <file>, the standard output if omitted\n-e<file>   Pack with the sue executable <file>, sue.exe next to the benchmark if omitted\n-f<opts>   Pass the switches <opts> to sue, e.g. -f\"-j4 -clz4\"\nThe files are generated into file.sue.files and packed by sue, then the archive is opened, read and extracted, the results are written as JSON.\n", argv[0]);
+
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    char root[MAX_PATH];
+
+    if (argc - x < 2) { strcpy(root, "__bench"); }
+    else { strcpy(root, argv[x + 1]); }
+
+    Initialize();
+    InitializeBenchmarkNames();
+
+    if (!GenerateArchive(argv[x])) { exit(EXIT_FAILURE); }
+
+    if (!BenchmarkArchiveOpen(argv[x]))
+    {
+        fprintf(stderr, "Could not open resource file: %s\n", argv[x]);
+
+        exit(EXIT_FAILURE);
+    }
+
+    BenchmarkArchiveItemLookup(true);
+    BenchmarkArchiveItemLookup(false);
+    BenchmarkSequentialRead();
+    BenchmarkRandomRead();
+
+    if (!BenchmarkExtraction(root)) { exit(EXIT_FAILURE); }
+
+    SaveBenchmarkResults(output);
+
+    ReleaseBenchmarkNames();
+    ReleaseArchiveItemChunks();
+    ReleaseArchives();
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
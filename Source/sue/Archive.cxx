@@ -23,21 +23,559 @@ SOFTWARE.
 #include "Archive.hxx"
 #include "State.hxx"
 
+#include <ctype.h>
 #include <io.h>
+#include <lz4.h>
+#include <lz4hc.h>
+#include <sys/stat.h>
 #include <zlib.h>
 
 #define SAVE_SIZE_MODIFIER  0x8000
 
+#define AUTOMATIC_SAMPLE_SIZE   0x10000
+#define AUTOMATIC_PACKED_RATIO  95 /* Percent, the sample that does not compress below it is packed. */
+
+#define AUTOMATIC_LARGE_FILE_SIZE           (16 * 1024 * 1024)
+#define AUTOMATIC_LARGE_BLOCK_MULTIPLIER    4
+
+static const char* AutomaticStreamExtensions[] = { ".avi", ".bik", ".mp3", ".mpg", ".ogg", ".smk", ".wav" };
+
 // 0x00401000
 void InitializeArchives(void) {
     State.Names.Next = State.Names.Names;
 
     State.Archive.Index = 0;
     State.Archive.Count = 0;
+
+    State.Hashes.Count = 0;
+}
+
+void ReleaseArchives(void) {
+    for (unsigned i = 0; i < State.Hashes.Count; i++) { free(State.Hashes.Items[i].Path); }
+
+    free(State.Hashes.Items);
+    free(State.Hashes.Buckets);
+    free(State.Names.Names);
+    free(State.Items);
+    free(State.Offsets);
+
+    State.Hashes.Count = 0;
+    State.Hashes.Capacity = 0;
+    State.Hashes.Items = NULL;
+    State.Hashes.BucketCount = 0;
+    State.Hashes.Buckets = NULL;
+
+    free(State.Index.Hashes);
+    free(State.Index.Items);
+
+    State.Index.Count = 0;
+    State.Index.Capacity = 0;
+    State.Index.Hashes = NULL;
+    State.Index.Items = NULL;
+
+    State.Names.Next = NULL;
+    State.Names.Capacity = 0;
+    State.Names.Names = NULL;
+
+    State.ItemCapacity = 0;
+    State.Items = NULL;
+
+    State.OffsetCapacity = 0;
+    State.Offsets = NULL;
+}
+
+void AcquireArchiveItems(const unsigned count) {
+    if (count <= State.ItemCapacity) { return; }
+
+    State.ItemCapacity = max(count, max(MIN_ARCHIVE_ITEM_COUNT, State.ItemCapacity * 2));
+    State.Items = (ARCHIVEITEMDESCRIPTOR64PTR)realloc(State.Items, State.ItemCapacity * sizeof(ARCHIVEITEMDESCRIPTOR64));
+}
+
+void AcquireArchiveNames(const size_t size) {
+    if (size <= State.Names.Capacity) { return; }
+
+    const size_t length = State.Names.Next - State.Names.Names;
+
+    State.Names.Capacity = max(size, max(MIN_ARCHIVE_NAME_SIZE, State.Names.Capacity * 2));
+    State.Names.Names = (char*)realloc(State.Names.Names, State.Names.Capacity);
+    State.Names.Next = State.Names.Names + length;
+}
+
+void AppendArchiveOffset(const long long offset) {
+    if (State.OffsetCapacity <= State.Archive.Index) {
+        State.OffsetCapacity = max(MIN_ARCHIVE_OFFSET_COUNT, State.OffsetCapacity * 2);
+        State.Offsets = (long long*)realloc(State.Offsets, State.OffsetCapacity * sizeof(long long));
+    }
+
+    State.Offsets[State.Archive.Index] = offset;
+    State.Archive.Index = State.Archive.Index + 1;
+}
+
+unsigned AcquireArchiveItemHashBucket(const unsigned long long length) {
+    return (unsigned)((length * 0x9E3779B97F4A7C15ULL) >> 32) & (State.Hashes.BucketCount - 1);
+}
+
+void InitializeArchiveItemHashBuckets(const unsigned count) {
+    free(State.Hashes.Buckets);
+
+    State.Hashes.BucketCount = count;
+    State.Hashes.Buckets = (int*)malloc(count * sizeof(int));
+
+    for (unsigned i = 0; i < count; i++) { State.Hashes.Buckets[i] = INVALID_ARCHIVE_ITEM_INDEX; }
+
+    // Re-chain the existing items.
+    for (unsigned i = 0; i < State.Hashes.Count; i++) {
+        const unsigned bucket = AcquireArchiveItemHashBucket(State.Hashes.Items[i].Length);
+
+        State.Hashes.Items[i].Next = State.Hashes.Buckets[bucket];
+        State.Hashes.Buckets[bucket] = i;
+    }
+}
+
+void AppendArchiveItemHash(const int hashed, const unsigned hash, const char* path, const unsigned long long length, ARCHIVEITEMDESCRIPTOR64PTR item) {
+    if (State.Hashes.Capacity <= State.Hashes.Count) {
+        State.Hashes.Capacity = max(MIN_ARCHIVE_ITEM_COUNT, State.Hashes.Capacity * 2);
+        State.Hashes.Items = (ARCHIVEITEMHASHPTR)realloc(State.Hashes.Items, State.Hashes.Capacity * sizeof(ARCHIVEITEMHASH));
+    }
+
+    // Keep a bucket per item at most.
+    if (State.Hashes.BucketCount <= State.Hashes.Count) {
+        InitializeArchiveItemHashBuckets(max(MIN_ARCHIVE_ITEM_COUNT, State.Hashes.BucketCount * 2));
+    }
+
+    const unsigned bucket = AcquireArchiveItemHashBucket(length);
+
+    State.Hashes.Items[State.Hashes.Count].IsHashed = hashed;
+    State.Hashes.Items[State.Hashes.Count].Hash = hash;
+    State.Hashes.Items[State.Hashes.Count].Length = length;
+    State.Hashes.Items[State.Hashes.Count].Next = State.Hashes.Buckets[bucket];
+    State.Hashes.Items[State.Hashes.Count].Path = _strdup(path);
+    State.Hashes.Items[State.Hashes.Count].Item = *item;
+
+    State.Hashes.Buckets[bucket] = State.Hashes.Count;
+
+    State.Hashes.Count = State.Hashes.Count + 1;
+}
+
+// NOTE:
+// Opens the existing archive for the update, the tables are loaded and left in place, the new content
+// and the new tables are appended after them, and the header is pointed to the new tables last on release,
+// so that the archive stays valid until then. The old tables are left in place as unused space.
+int OpenArchive(const char* name) {
+    State.Archive.File = fopen(name, "r+b");
+
+    if (State.Archive.File == NULL) { return FALSE; }
+
+    {
+        struct _stat64 info;
+        _fstat64(_fileno(State.Archive.File), &info);
+
+        State.Archive.Time = info.st_mtime;
+    }
+
+    unsigned value[2] = { 0, 0 };
+    fread(value, 1, sizeof(value), State.Archive.File);
+
+    long long header = 0, offset = 0;
+
+    if (value[0] == ARCHIVE_MAGIC) {
+        header = sizeof(value);
+        offset = value[1];
+
+        State.IsLarge = FALSE;
+    }
+    else if (value[0] == ARCHIVE_MAGIC_64 && value[1] == ARCHIVE_VERSION_64) {
+        header = sizeof(value) + sizeof(long long);
+        fread(&offset, 1, sizeof(long long), State.Archive.File);
+
+        State.IsLarge = TRUE;
+    }
+    else {
+        fprintf(stderr, "ERROR: %s is not an archive\n", name);
+        exit(EXIT_FAILURE);
+    }
+
+    _fseeki64(State.Archive.File, header + offset, SEEK_SET);
+
+    unsigned count = 0, size = 0;
+
+    void* items = Load(&count, &size);
+    void* names = Load(NULL, &size);
+
+    AcquireArchiveItems(count);
+    AcquireArchiveNames(size);
+
+    State.Archive.Count = count;
+
+    memcpy(State.Names.Names, names, size);
+    State.Names.Next = State.Names.Names + size;
+
+    InitializeArchiveItemIndex(count * 2);
+
+    for (unsigned i = 0; i < count; i++) {
+        if (State.IsLarge) { State.Items[i] = ((ARCHIVEITEMDESCRIPTOR64PTR)items)[i]; }
+        else {
+            ARCHIVEITEMDESCRIPTORPTR item = &((ARCHIVEITEMDESCRIPTORPTR)items)[i];
+
+            State.Items[i].Name = item->Name;
+            State.Items[i].Type = item->Type;
+            State.Items[i].Offset = item->Offset;
+            State.Items[i].Size = item->Size;
+            State.Items[i].Chunk = item->Chunk;
+            State.Items[i].Reserved = 0;
+        }
+
+        AppendArchiveItemIndex(i);
+    }
+
+    void* offsets = Load(&count, NULL);
+
+    for (unsigned i = 0; i < count; i++) {
+        AppendArchiveOffset(State.IsLarge ? ((long long*)offsets)[i] : ((unsigned*)offsets)[i]);
+    }
+
+    free(items);
+    free(names);
+    free(offsets);
+
+    _fseeki64(State.Archive.File, 0, SEEK_END);
+
+    return TRUE;
+}
+
+unsigned AcquireArchiveNameHash(const char* name) {
+    // NOTE: The names are compared case-insensitively, so is the hash.
+    Bytef value[MAX_FILE_NAME_LENGTH];
+
+    unsigned result = crc32(0, NULL, 0);
+    unsigned length = 0;
+
+    for (const char* x = name; ; x++) {
+        if (*x != NULL) {
+            value[length] = (Bytef)tolower((unsigned char)*x);
+            length = length + 1;
+        }
+
+        if (*x == NULL || length == MAX_FILE_NAME_LENGTH) {
+            result = crc32(result, value, length);
+            length = 0;
+        }
+
+        if (*x == NULL) { break; }
+    }
+
+    return result;
+}
+
+void InitializeArchiveItemIndex(const unsigned count) {
+    const unsigned capacity = State.Index.Capacity;
+    unsigned* hashes = State.Index.Hashes;
+    int* items = State.Index.Items;
+
+    State.Index.Count = 0;
+    State.Index.Capacity = MIN_ARCHIVE_INDEX_COUNT;
+
+    while (State.Index.Capacity < count) { State.Index.Capacity = State.Index.Capacity * 2; }
+
+    State.Index.Hashes = (unsigned*)malloc(State.Index.Capacity * sizeof(unsigned));
+    State.Index.Items = (int*)malloc(State.Index.Capacity * sizeof(int));
+
+    for (unsigned i = 0; i < State.Index.Capacity; i++) { State.Index.Items[i] = INVALID_ARCHIVE_ITEM_INDEX; }
+
+    // Re-insert the existing items with their stored hashes.
+    for (unsigned i = 0; i < capacity; i++) {
+        if (items[i] == INVALID_ARCHIVE_ITEM_INDEX) { continue; }
+
+        unsigned slot = hashes[i] & (State.Index.Capacity - 1);
+
+        while (State.Index.Items[slot] != INVALID_ARCHIVE_ITEM_INDEX) { slot = (slot + 1) & (State.Index.Capacity - 1); }
+
+        State.Index.Hashes[slot] = hashes[i];
+        State.Index.Items[slot] = items[i];
+        State.Index.Count = State.Index.Count + 1;
+    }
+
+    free(hashes);
+    free(items);
+}
+
+void AppendArchiveItemIndex(const int indx) {
+    // Keep the table at most half full.
+    if (State.Index.Capacity < (State.Index.Count + 1) * 2) { InitializeArchiveItemIndex(State.Index.Capacity * 2); }
+
+    const unsigned hash = AcquireArchiveNameHash(&State.Names.Names[State.Items[indx].Name]);
+
+    unsigned slot = hash & (State.Index.Capacity - 1);
+
+    while (State.Index.Items[slot] != INVALID_ARCHIVE_ITEM_INDEX) { slot = (slot + 1) & (State.Index.Capacity - 1); }
+
+    State.Index.Hashes[slot] = hash;
+    State.Index.Items[slot] = indx;
+    State.Index.Count = State.Index.Count + 1;
+}
+
+int AcquireArchiveItem(const char* name) {
+    if (State.Index.Capacity == 0) { return INVALID_ARCHIVE_ITEM_INDEX; }
+
+    const unsigned hash = AcquireArchiveNameHash(name);
+
+    for (unsigned slot = hash & (State.Index.Capacity - 1); ; slot = (slot + 1) & (State.Index.Capacity - 1)) {
+        const int indx = State.Index.Items[slot];
+
+        if (indx == INVALID_ARCHIVE_ITEM_INDEX) { return INVALID_ARCHIVE_ITEM_INDEX; }
+
+        if (State.Index.Hashes[slot] == hash && _strcmpi(&State.Names.Names[State.Items[indx].Name], name) == 0) { return indx; }
+    }
+
+    return INVALID_ARCHIVE_ITEM_INDEX;
+}
+
+// NOTE:
+// The archive keeps neither the time nor the checksum of the items, so the file is considered
+// modified once it was written after the archive, or is to be stored in a different way.
+int IsArchiveItemModified(const int indx, const int block, const unsigned long long length, const long long time) {
+    const ARCHIVEITEMTYPE type = AcquireArchiveItemType(block);
+
+    if (State.IsAutomatic) {
+        // The automatic mode picks the way to store each file, so any of its choices is kept.
+        if (State.Items[indx].Type != ARCHIVEITEMTYPE_PACKED && State.Items[indx].Type != type) { return TRUE; }
+    }
+    else {
+        if (State.Items[indx].Type != type) { return TRUE; }
+        if (type != ARCHIVEITEMTYPE_PACKED && State.Items[indx].Chunk != (unsigned)block) { return TRUE; }
+    }
+
+    if (State.Archive.Time <= time) { return TRUE; }
+
+    // The size of the gzip compressed files is only known once they are decompressed.
+    if (State.SkipExtraction && State.Items[indx].Size != length) { return TRUE; }
+
+    return FALSE;
+}
+
+ARCHIVEITEMTYPE AcquireArchiveItemType(const int block) {
+    return (block == 0 || State.Compression == Z_NO_COMPRESSION) ? ARCHIVEITEMTYPE_PACKED : State.Codec;
+}
+
+unsigned AcquireArchiveBlockBound(const unsigned size) {
+    return State.Codec == ARCHIVEITEMTYPE_LZ4 ? LZ4_compressBound(size) : compressBound(size);
+}
+
+unsigned CompressArchiveBlock(void* output, const unsigned capacity, const void* input, const unsigned size) {
+    const long long start = AcquireStatisticsTime();
+
+    uLong length = capacity;
+
+    if (State.Codec == ARCHIVEITEMTYPE_LZ4) {
+        // NOTE: The low levels use the fast compressor, the rest use the high compression one at the same level.
+        length = State.Compression < LZ4HC_CLEVEL_MIN
+            ? LZ4_compress_default((const char*)input, (char*)output, size, capacity)
+            : LZ4_compress_HC((const char*)input, (char*)output, size, capacity, State.Compression);
+    }
+    else { compress2((Bytef*)output, &length, (const Bytef*)input, (uLong)size, State.Compression); }
+
+    ReleaseStatisticsTime(STATISTICSPHASE_COMPRESS, start, size);
+
+    return length;
+}
+
+void AppendArchiveItem(const int indx, const char* name) {
+    const size_t len = strlen(name);
+
+    AcquireArchiveNames((State.Names.Next - State.Names.Names) + len + 1);
+
+    State.Items[indx].Name = (unsigned)(State.Names.Next - State.Names.Names);
+
+    strcpy(State.Names.Next, name);
+
+    State.Names.Next = State.Names.Next + len + 1;
+
+    State.Archive.Count = State.Archive.Count + 1;
+
+    // The later files of the same name find this item, as they find the loaded ones.
+    if (State.IsUpdate) { AppendArchiveItemIndex(indx); }
+}
+
+unsigned AcquireArchiveFileHash(void* file, unsigned long long* size) {
+    unsigned result = crc32(0, NULL, 0);
+
+    *size = 0;
+
+    while (true) {
+        const int end = State.SkipExtraction
+            ? feof((FILE*)file) : gzeof((gzFile)file);
+
+        if (end) { break; }
+
+        const size_t length = State.SkipExtraction
+            ? fread(State.Content.In, 1, MAX_CONTENT_IN_SIZE, (FILE*)file)
+            : gzread((gzFile)file, State.Content.In, MAX_CONTENT_IN_SIZE);
+
+        result = crc32(result, State.Content.In, (uInt)length);
+
+        *size = *size + length;
+    }
+
+    RewindArchiveFile(file);
+
+    return result;
+}
+
+unsigned AcquireArchivePathHash(const char* path, unsigned long long* size) {
+    void* file = State.SkipExtraction
+        ? (void*)fopen(path, "rb") : (void*)gzopen(path, "rb");
+
+    *size = 0;
+
+    if (file == NULL) { return 0; }
+
+    const unsigned result = AcquireArchiveFileHash(file, size);
+
+    if (State.SkipExtraction) { fclose((FILE*)file); }
+    else { gzclose((gzFile)file); }
+
+    return result;
+}
+
+void RewindArchiveFile(void* file) {
+    if (State.SkipExtraction) { rewind((FILE*)file); }
+    else { gzrewind((gzFile)file); }
+}
+
+// NOTE:
+// The sample is compressed with the codec and the level of the archive, the content that does not compress is packed.
+// The files that fit a large block keep the requested block, the streamed media is read front to back,
+// so it gets the large blocks for fewer decompressions, and the large files get larger blocks than requested,
+// while the rest keeps the requested blocks for the random access.
+int AcquireArchiveFileBlock(void* file, const char* path, const unsigned long long length, const int block) {
+    if (block == 0 || State.Compression == Z_NO_COMPRESSION) { return block; }
+
+    const size_t size = State.SkipExtraction
+        ? fread(State.Content.In, 1, AUTOMATIC_SAMPLE_SIZE, (FILE*)file)
+        : gzread((gzFile)file, State.Content.In, AUTOMATIC_SAMPLE_SIZE);
+
+    RewindArchiveFile(file);
+
+    if (size == 0) { return block; }
+
+    const unsigned result = CompressArchiveBlock(State.Content.Out, MAX_CONTENT_OUT_SIZE, State.Content.In, (unsigned)size);
+
+    if (result == 0 || size * AUTOMATIC_PACKED_RATIO <= (size_t)result * 100) { return 0; }
+
+    if (length <= MAX_CONTENT_IN_SIZE) { return block; }
+
+    const char* extension = strrchr(path, '.');
+
+    if (extension != NULL) {
+        for (unsigned i = 0; i < sizeof(AutomaticStreamExtensions) / sizeof(AutomaticStreamExtensions[0]); i++) {
+            if (_strcmpi(extension, AutomaticStreamExtensions[i]) == 0) { return MAX_CONTENT_IN_SIZE; }
+        }
+    }
+
+    if (AUTOMATIC_LARGE_FILE_SIZE <= length) { return max(block, min(MAX_CONTENT_IN_SIZE, block * AUTOMATIC_LARGE_BLOCK_MULTIPLIER)); }
+
+    return block;
+}
+
+int IsArchiveFileEqual(const char* path, const char* other) {
+    void* files[2] = {
+        State.SkipExtraction ? (void*)fopen(path, "rb") : (void*)gzopen(path, "rb"),
+        State.SkipExtraction ? (void*)fopen(other, "rb") : (void*)gzopen(other, "rb") };
+
+    int result = files[0] != NULL && files[1] != NULL;
+
+    while (result) {
+        const size_t size = State.SkipExtraction
+            ? fread(State.Content.In, 1, MAX_CONTENT_IN_SIZE, (FILE*)files[0])
+            : gzread((gzFile)files[0], State.Content.In, MAX_CONTENT_IN_SIZE);
+
+        const size_t length = State.SkipExtraction
+            ? fread(State.Content.Out, 1, MAX_CONTENT_IN_SIZE, (FILE*)files[1])
+            : gzread((gzFile)files[1], State.Content.Out, MAX_CONTENT_IN_SIZE);
+
+        result = size == length && memcmp(State.Content.In, State.Content.Out, size) == 0;
+
+        if (size == 0) { break; }
+    }
+
+    for (int i = 0; i < 2; i++) {
+        if (files[i] == NULL) { continue; }
+
+        if (State.SkipExtraction) { fclose((FILE*)files[i]); }
+        else { gzclose((gzFile)files[i]); }
+    }
+
+    return result;
+}
+
+// NOTE:
+// A file is only hashed once a file of the same size and storage was stored before it, and that file
+// is hashed then as well, so the unique files are read once. The hash only narrows down the candidates,
+// the files are compared byte by byte before the content is shared.
+// The content is shared by the whole items only, since the size of a compressed block is the distance
+// to the offset of the next block of the same item.
+ARCHIVEITEMHASHPTR AcquireArchiveItemDuplicate(void* file, const char* path, const unsigned long long length, const int block, int* hashed, unsigned* hash) {
+    const ARCHIVEITEMTYPE type = AcquireArchiveItemType(block);
+
+    *hashed = FALSE;
+
+    if (State.Hashes.BucketCount == 0) { return NULL; }
+
+    unsigned long long size = 0;
+
+    for (int i = State.Hashes.Buckets[AcquireArchiveItemHashBucket(length)]; i != INVALID_ARCHIVE_ITEM_INDEX; i = State.Hashes.Items[i].Next) {
+        ARCHIVEITEMHASHPTR item = &State.Hashes.Items[i];
+
+        if (item->Length != length || item->Item.Type != type) { continue; }
+        if (type != ARCHIVEITEMTYPE_PACKED && item->Item.Chunk != (unsigned)block) { continue; }
+
+        if (!*hashed) {
+            const long long start = AcquireStatisticsTime();
+
+            *hash = AcquireArchiveFileHash(file, &size);
+            *hashed = TRUE;
+
+            ReleaseStatisticsTime(STATISTICSPHASE_HASH, start, size);
+        }
+
+        if (!item->IsHashed) {
+            unsigned long long value = 0;
+            const long long start = AcquireStatisticsTime();
+
+            item->Hash = AcquireArchivePathHash(item->Path, &value);
+            item->IsHashed = TRUE;
+
+            ReleaseStatisticsTime(STATISTICSPHASE_HASH, start, value);
+        }
+
+        if (item->Hash != *hash || item->Item.Size != size) { continue; }
+
+        if (IsArchiveFileEqual(path, item->Path)) { return item; }
+    }
+
+    return NULL;
 }
 
 // 0x00401020
-void ArchiveFile(const char* path, const char* name, int block) {
+// NOTE: The length and the time of the file are the ones it was listed with, the file is not examined again.
+void ArchiveFile(const char* path, const char* name, int block, const unsigned long long length, const long long time) {
+    // The unchanged items of the archive being updated are kept as they are, the modified ones are replaced.
+    int indx = State.IsUpdate ? AcquireArchiveItem(name) : INVALID_ARCHIVE_ITEM_INDEX;
+
+    if (indx != INVALID_ARCHIVE_ITEM_INDEX && !IsArchiveItemModified(indx, block, length, time)) {
+        if (!State.IsSilent) { printf("%s->%s unchanged\n", path, name); }
+
+        return;
+    }
+
+    const int replace = indx != INVALID_ARCHIVE_ITEM_INDEX;
+
+    if (!replace) {
+        indx = State.Archive.Count;
+
+        AcquireArchiveItems(State.Archive.Count + 1);
+    }
+
     void* file = State.SkipExtraction
         ? (void*)fopen(path, "rb") : (void*)gzopen(path, "rb");
 
@@ -46,11 +584,38 @@ void ArchiveFile(const char* path, const char* name, int block) {
         return;
     }
 
+    if (State.IsAutomatic) { block = AcquireArchiveFileBlock(file, path, length, block); }
+
+    // Byte-identical files share the content stored for the first of them.
+    int hashed = FALSE;
+    unsigned hash = 0;
+
+    if (!State.SkipDeduplication) {
+        ARCHIVEITEMHASHPTR duplicate = AcquireArchiveItemDuplicate(file, path, length, block, &hashed, &hash);
+
+        if (duplicate != NULL) {
+            if (State.SkipExtraction) { fclose((FILE*)file); }
+            else { gzclose((gzFile)file); }
+
+            State.Items[indx].Type = duplicate->Item.Type;
+            State.Items[indx].Offset = duplicate->Item.Offset;
+            State.Items[indx].Size = duplicate->Item.Size;
+            State.Items[indx].Chunk = duplicate->Item.Chunk;
+            State.Items[indx].Reserved = 0;
+
+            if (!replace) { AppendArchiveItem(indx, name); }
+
+            if (!State.IsSilent) { printf("%s->%s %d->0 duplicate of %s\n", path, name, (unsigned)duplicate->Item.Size, duplicate->Path); }
+
+            return;
+        }
+    }
+
     size_t read = 0, write = 0;
 
     if (block == 0 || State.Compression == Z_NO_COMPRESSION) {
-        State.Items[State.Archive.Count].Type = ARCHIVEITEMTYPE_PACKED;
-        State.Items[State.Archive.Count].Offset = ftell(State.Archive.File);
+        State.Items[indx].Type = ARCHIVEITEMTYPE_PACKED;
+        State.Items[indx].Offset = _ftelli64(State.Archive.File);
 
         while (true) {
             const int end = State.SkipExtraction
@@ -58,61 +623,75 @@ void ArchiveFile(const char* path, const char* name, int block) {
 
             if (end) { break; }
 
+            long long start = AcquireStatisticsTime();
+
             const size_t size = State.SkipExtraction
                 ? fread(State.Content.In, 1, MAX_CONTENT_IN_SIZE, (FILE*)file)
                 : gzread((gzFile)file, State.Content.In, MAX_CONTENT_IN_SIZE);
 
+            ReleaseStatisticsTime(STATISTICSPHASE_READ, start, size);
+
+            start = AcquireStatisticsTime();
+
             fwrite(State.Content.In, 1, size, State.Archive.File);
 
+            ReleaseStatisticsTime(STATISTICSPHASE_WRITE, start, size);
+
             read = read + size;
         }
 
         write = read;
     }
     else {
-        State.Items[State.Archive.Count].Type = ARCHIVEITEMTYPE_COMPRESSED;
-        State.Items[State.Archive.Count].Offset = State.Archive.Index;
+        State.Items[indx].Type = State.Codec;
+        State.Items[indx].Offset = State.Archive.Index;
 
-        while (true) {
-            const int end = State.SkipExtraction
-                ? feof((FILE*)file) : gzeof((gzFile)file);
+        if (State.Pipeline.IsActive) { CompressArchiveFile(file, block, &read, &write); }
+        else {
+            while (true) {
+                const int end = State.SkipExtraction
+                    ? feof((FILE*)file) : gzeof((gzFile)file);
 
-            if (end) { break; }
+                if (end) { break; }
 
-            const size_t size = State.SkipExtraction
-                ? fread(State.Content.In, 1, block, (FILE*)file)
-                : gzread((gzFile)file, State.Content.In, block);
+                long long start = AcquireStatisticsTime();
 
-            read = read + size;
+                const size_t size = State.SkipExtraction
+                    ? fread(State.Content.In, 1, block, (FILE*)file)
+                    : gzread((gzFile)file, State.Content.In, block);
+
+                ReleaseStatisticsTime(STATISTICSPHASE_READ, start, size);
+
+                read = read + size;
 
-            uLong length = MAX_CONTENT_OUT_SIZE;
-            compress2(State.Content.Out, &length, State.Content.In, (uLong)size, State.Compression);
+                const unsigned length = CompressArchiveBlock(State.Content.Out, MAX_CONTENT_OUT_SIZE, State.Content.In, (unsigned)size);
 
-            State.Offsets[State.Archive.Index] = ftell(State.Archive.File);
-            State.Archive.Index = State.Archive.Index + 1;
+                AppendArchiveOffset(_ftelli64(State.Archive.File));
 
-            fwrite(State.Content.Out, 1, length, State.Archive.File);
+                start = AcquireStatisticsTime();
 
-            write = write + length;
+                fwrite(State.Content.Out, 1, length, State.Archive.File);
+
+                ReleaseStatisticsTime(STATISTICSPHASE_WRITE, start, length);
+
+                write = write + length;
+            }
         }
 
-        State.Offsets[State.Archive.Index] = ftell(State.Archive.File);
-        State.Archive.Index = State.Archive.Index + 1;
+        AppendArchiveOffset(_ftelli64(State.Archive.File));
     }
 
     if (State.SkipExtraction) { fclose((FILE*)file); }
     else { gzclose((gzFile)file); }
 
-    State.Items[State.Archive.Count].Chunk = block;
-    State.Items[State.Archive.Count].Name = (unsigned)(State.Names.Next - State.Names.Names);
+    State.Items[indx].Chunk = block;
+    State.Items[indx].Reserved = 0;
+    State.Items[indx].Size = read;
 
-    const size_t len = strlen(name);
-    strcpy(State.Names.Next, name);
+    if (!replace) { AppendArchiveItem(indx, name); }
 
-    State.Names.Next = State.Names.Next + len + 1;
-    State.Items[State.Archive.Count].Size = (unsigned)read;
+    if (!State.SkipDeduplication) { AppendArchiveItemHash(hashed, hash, path, length, &State.Items[indx]); }
 
-    State.Archive.Count = State.Archive.Count + 1;
     State.Archive.Size = State.Archive.Size + (unsigned)write;
 
     if (!State.IsSilent) { printf("%s->%s %d->%d\n", path, name, (unsigned)read, (unsigned)write); }
@@ -120,6 +699,8 @@ void ArchiveFile(const char* path, const char* name, int block) {
 
 // 0x004013d0
 void Save(const void* data, const unsigned count, const unsigned size) {
+    const long long start = AcquireStatisticsTime();
+
     uLongf length = count * size + SAVE_SIZE_MODIFIER;
 
     Bytef* content = (Bytef*)malloc(length);
@@ -131,6 +712,39 @@ void Save(const void* data, const unsigned count, const unsigned size) {
     fwrite(content, 1, length, State.Archive.File);
 
     free(content);
+
+    ReleaseStatisticsTime(STATISTICSPHASE_INDEX, start, count * size);
+}
+
+void* Load(unsigned* count, unsigned* size) {
+    const long long start = AcquireStatisticsTime();
+
+    uLongf length = 0;
+    unsigned items = 0, item = 0;
+
+    fread(&length, 1, sizeof(uLongf), State.Archive.File);
+    fread(&items, 1, sizeof(unsigned), State.Archive.File);
+    fread(&item, 1, sizeof(unsigned), State.Archive.File);
+
+    Bytef* content = (Bytef*)malloc(length);
+    fread(content, 1, length, State.Archive.File);
+
+    uLongf actual = items * item;
+    Bytef* result = (Bytef*)malloc(actual + 1);
+
+    if (uncompress(result, &actual, content, length) != Z_OK) {
+        fprintf(stderr, "ERROR: the archive tables are corrupted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    free(content);
+
+    ReleaseStatisticsTime(STATISTICSPHASE_INDEX, start, items * item);
+
+    if (count != NULL) { *count = items; }
+    if (size != NULL) { *size = items * item; }
+
+    return result;
 }
 
 // 0x00401530
@@ -147,7 +761,14 @@ void ArchivePath(const char* path, const char* name, const char* pattern, const
 
                 while (path[end] != '\\' && path[end] != '/') { end = end - 1; }
 
-                ArchiveFile(path, &path[end + 1], block);
+                struct _stat64 info;
+
+                if (_stat64(path, &info) != 0) {
+                    fprintf(stderr, "ERROR: could not open %s\n", path);
+                    return;
+                }
+
+                ArchiveFile(path, &path[end + 1], block, info.st_size, info.st_mtime);
 
                 return;
             }
@@ -155,48 +776,54 @@ void ArchivePath(const char* path, const char* name, const char* pattern, const
     }
 
     // Directory
+    ArchiveDirectory(AcquireScannerDirectory(path, pattern, subdirs), name, block, flatten);
+}
+
+// NOTE:
+// The entries are walked in sorted order, so the archive does not depend on the file system order,
+// and each subdirectory is waited for only when reached, while the scanner threads list the ones ahead.
+void ArchiveDirectory(SCANNERDIRECTORYPTR directory, const char* name, const int block, const int flatten) {
     {
-        char file[MAX_FILE_NAME_LENGTH];
-        sprintf(file, "%s%s", path, pattern);
+        const long long start = AcquireStatisticsTime();
 
-        _finddata_t context;
-        intptr_t handle = _findfirst(file, &context);
+        WaitForSingleObject(directory->Event, INFINITE);
 
-        if (handle == -1) {
-            if (errno == ENOENT) {
-                fprintf(stderr, "Warning: no files in %s\n", path);
-                return;
-            }
+        ReleaseStatisticsTime(STATISTICSPHASE_SCAN, start, 0);
+    }
 
-            fprintf(stderr, "Error: bad path %s\n", path);
-            exit(EXIT_FAILURE);
+    if (directory->Result != 0) {
+        if (directory->Result == ENOENT) {
+            fprintf(stderr, "Warning: no files in %s\n", directory->Path);
+            ReleaseScannerDirectory(directory);
+
+            return;
         }
 
-        char dir[MAX_FILE_NAME_LENGTH];
-        char tag[MAX_FILE_NAME_LENGTH];
+        fprintf(stderr, "Error: bad path %s\n", directory->Path);
+        exit(EXIT_FAILURE);
+    }
 
-        do {
-            if (!(context.attrib & _A_SUBDIR)) {
+    char dir[MAX_FILE_NAME_LENGTH];
+    char tag[MAX_FILE_NAME_LENGTH];
 
-                sprintf(dir, "%s%s", path, context.name);
-                sprintf(tag, "%s%s", name, context.name);
+    for (unsigned i = 0; i < directory->Count; i++) {
+        SCANNERENTRYPTR entry = &directory->Entries[i];
 
-                ArchiveFile(dir, tag, block);
-            }
-            else {
-                if (strcmp(context.name, ".") != 0) {
-                    if (strcmp(context.name, "..") != 0 && subdirs) {
-                        sprintf(dir, "%s%s\\", path, context.name);
+        if (entry->Directory == NULL) {
+            sprintf(dir, "%s%s", directory->Path, entry->Name);
+            sprintf(tag, "%s%s", name, entry->Name);
 
-                        if (!flatten) { sprintf(tag, "%s%s\\", name, context.name); }
-                        else { strcpy(tag, name); }
+            ArchiveFile(dir, tag, block, entry->Size, entry->Time);
+        }
+        else {
+            if (!State.IsSilent) { printf("Adding %s; blocksize=%d\n", entry->Directory->Path, block); }
 
-                        ArchivePath(dir, tag, pattern, block, subdirs, flatten);
-                    }
-                }
-            }
-        } while (_findnext(handle, &context) == 0);
+            if (!flatten) { sprintf(tag, "%s%s\\", name, entry->Name); }
+            else { strcpy(tag, name); }
 
-        _findclose(handle);
+            ArchiveDirectory(entry->Directory, tag, block, flatten);
+        }
     }
+
+    ReleaseScannerDirectory(directory);
 }
\ No newline at end of file
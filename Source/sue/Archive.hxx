@@ -23,8 +23,16 @@ SOFTWARE.
 #pragma once
 
 #include "Base.hxx"
+#include "Scanner.hxx"
 
 #define ARCHIVE_MAGIC               0x53465A46 /* FZFS */
+#define ARCHIVE_MAGIC_64            0x34365A46 /* FZ64 */
+
+#define ARCHIVE_VERSION_64          1
+
+#define MAX_ARCHIVE_SIZE            0xFFFFFFFF
+
+#define INVALID_ARCHIVE_ITEM_INDEX  (-1)
 
 typedef enum ArchiveItemType
 {
@@ -32,6 +40,7 @@ typedef enum ArchiveItemType
     ARCHIVEITEMTYPE_FILE            = 1, // Straight unpacked file
     ARCHIVEITEMTYPE_PACKED          = 2, // Packaged into an archive without compression
     ARCHIVEITEMTYPE_COMPRESSED      = 8, // Packaged into an archive with zlib compression
+    ARCHIVEITEMTYPE_LZ4             = 16, // Packaged into an archive with LZ4 compression, not supported by the game
     ARCHIVEITEMTYPE_FORCE_DWORD     = 0x7FFFFFFF
 } ARCHIVEITEMTYPE, * ARCHIVEITEMTYPEPTR;
 
@@ -44,9 +53,58 @@ typedef struct ArchiveItemDescriptor
     unsigned                    Chunk;
 } ARCHIVEITEMDESCRIPTOR, * ARCHIVEITEMDESCRIPTORPTR;
 
+// NOTE:
+// The item of a large archive, the offsets table of such an archive is made of 64-bit values as well.
+typedef struct ArchiveItemDescriptor64
+{
+    unsigned                    Name;
+    ARCHIVEITEMTYPE             Type;
+    unsigned long long          Offset; // Offset to the content within a file.
+    unsigned long long          Size;
+    unsigned                    Chunk;
+    unsigned                    Reserved;
+} ARCHIVEITEMDESCRIPTOR64, * ARCHIVEITEMDESCRIPTOR64PTR;
+
+typedef struct ArchiveItemHash {
+    int                         IsHashed;
+    unsigned                    Hash;   // CRC-32 of the content, once hashed.
+    unsigned long long          Length; // The size of the file on disk.
+    int                         Next;   // The next item of the same bucket.
+    char*                       Path;
+    ARCHIVEITEMDESCRIPTOR64     Item;
+} ARCHIVEITEMHASH, * ARCHIVEITEMHASHPTR;
+
 void InitializeArchives();
+void ReleaseArchives();
+
+void AcquireArchiveItems(const unsigned count);
+void AcquireArchiveNames(const size_t size);
+void AppendArchiveOffset(const long long offset);
+unsigned AcquireArchiveItemHashBucket(const unsigned long long length);
+void InitializeArchiveItemHashBuckets(const unsigned count);
+void AppendArchiveItemHash(const int hashed, const unsigned hash, const char* path, const unsigned long long length, ARCHIVEITEMDESCRIPTOR64PTR item);
+int OpenArchive(const char* name);
 
 void Save(const void* data, const unsigned count, const unsigned size);
+void* Load(unsigned* count, unsigned* size);
+
+unsigned AcquireArchiveNameHash(const char* name);
+void InitializeArchiveItemIndex(const unsigned count);
+void AppendArchiveItemIndex(const int indx);
+int AcquireArchiveItem(const char* name);
+int IsArchiveItemModified(const int indx, const int block, const unsigned long long length, const long long time);
+ARCHIVEITEMTYPE AcquireArchiveItemType(const int block);
+unsigned AcquireArchiveBlockBound(const unsigned size);
+unsigned CompressArchiveBlock(void* output, const unsigned capacity, const void* input, const unsigned size);
+void AppendArchiveItem(const int indx, const char* name);
+
+unsigned AcquireArchiveFileHash(void* file, unsigned long long* size);
+unsigned AcquireArchivePathHash(const char* path, unsigned long long* size);
+void RewindArchiveFile(void* file);
+int AcquireArchiveFileBlock(void* file, const char* path, const unsigned long long length, const int block);
+int IsArchiveFileEqual(const char* path, const char* other);
+ARCHIVEITEMHASHPTR AcquireArchiveItemDuplicate(void* file, const char* path, const unsigned long long length, const int block, int* hashed, unsigned* hash);
 
-void ArchiveFile(const char* path, const char* name, const int block);
-void ArchivePath(const char* path, const char* name, const char* pattern, const int block, const int subdirs, const int flatten);
\ No newline at end of file
+void ArchiveFile(const char* path, const char* name, const int block, const unsigned long long length, const long long time);
+void ArchivePath(const char* path, const char* name, const char* pattern, const int block, const int subdirs, const int flatten);
+void ArchiveDirectory(SCANNERDIRECTORYPTR directory, const char* name, const int block, const int flatten);
\ No newline at end of file
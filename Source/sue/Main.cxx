@@ -26,12 +26,13 @@ SOFTWARE.
 #include <zlib.h>
 
 #define USAGE_TEXT_MESSAGE \
-    "Syntax: %s [switches] file.sue name1 [name2 ...]\n-q         Quiet (no output)\n-m<n>      Compression level=<n>, 0-no compression, 1-fast, 9-best(default)\n-n         Disable pre-decompressing of gzip comressed files\n-b<nnn>    Compression block size=<nnn>, default=16384\n-s         Do not compress subdirectories\n-f         Flatten directory structure\nName can stand for a file or a directory.\nDirectory names should end with a backslash.\n"
+    "Syntax: %s [switches] file.sue name1 [name2 ...]\n-q         Quiet (no output)\n-a         Pick the block size per file, and pack the files that do not compress\n-m<n>      Compression level=<n>, 0-no compression, 1-fast, 9-best(default)\n-n         Disable pre-decompressing of gzip comressed files\n-d         Do not share the content of identical files\n-b<nnn>    Compression block size=<nnn>, default=16384\n-c<codec>  Compression codec=<codec>, zlib(default) or lz4, lz4 archives are not supported by the game\n-s         Do not compress subdirectories\n-f         Flatten directory structure\n-t<n>      Scan directories with <n> threads, default=1\n-j<n>      Compress with <n> threads, all processors if omitted\n-l         Large archive with 64-bit offsets, for over 4 GB\n-u         Update the existing archive, only new and modified files are compressed\n-v<mode>   Report the time and the bytes of each phase, the mode is summary(default), trace or json, json implies -q\nName can stand for a file or a directory.\nDirectory names should end with a backslash.\n"
 
 APPSTATE State;
 
 void Initialize() {
     State.Compression = Z_BEST_COMPRESSION;
+    State.Codec = ARCHIVEITEMTYPE_COMPRESSED;
 
     State.Names.Next = State.Names.Names;
 }
@@ -39,6 +40,14 @@ void Initialize() {
 // 0x00401340
 void Initialize(const char* name) {
     InitializeArchives();
+
+    // NOTE: The existing archive keeps its format, regardless of the -l switch.
+    if (State.IsUpdate && OpenArchive(name)) {
+        if (!State.IsSilent) { printf("Updating %s\n\n", name); }
+
+        return;
+    }
+
     State.Archive.File = fopen(name, "wb");
 
     if (State.Archive.File == NULL) {
@@ -48,6 +57,16 @@ void Initialize(const char* name) {
 
     if (!State.IsSilent) { printf("Compressing to %s\n\n", name); }
 
+    if (State.IsLarge) {
+        const unsigned value[] = { ARCHIVE_MAGIC_64, ARCHIVE_VERSION_64 };
+        const long long offset = 0;
+
+        fwrite(value, 1, sizeof(value), State.Archive.File);
+        fwrite(&offset, 1, sizeof(long long), State.Archive.File);
+
+        return;
+    }
+
     const unsigned value = ARCHIVE_MAGIC;
 
     fwrite(&value, 1, sizeof(unsigned), State.Archive.File);
@@ -56,17 +75,57 @@ void Initialize(const char* name) {
 
 // 0x00401470
 void Release() {
-    // File length less 8 bytes:
-    // 1. 4 bytes for the magic.
-    // 2. 4 bytes for the actual content size value.
-    const long offset = ftell(State.Archive.File) - (2 * sizeof(unsigned));
+    if (State.IsLarge) {
+        // File length less 16 bytes:
+        // 1. 4 bytes for the magic.
+        // 2. 4 bytes for the version.
+        // 3. 8 bytes for the actual content size value.
+        const long long offset = _ftelli64(State.Archive.File) - (2 * sizeof(unsigned) + sizeof(long long));
+
+        Save(State.Items, State.Archive.Count, sizeof(ARCHIVEITEMDESCRIPTOR64));
+        Save(State.Names.Names, 1, (unsigned)(State.Names.Next - State.Names.Names));
+        Save(State.Offsets, State.Archive.Index, sizeof(long long));
+
+        _fseeki64(State.Archive.File, 2 * sizeof(unsigned), SEEK_SET);
+        fwrite(&offset, 1, sizeof(long long), State.Archive.File);
+    }
+    else {
+        // File length less 8 bytes:
+        // 1. 4 bytes for the magic.
+        // 2. 4 bytes for the actual content size value.
+        const long long offset = _ftelli64(State.Archive.File) - (2 * sizeof(unsigned));
+
+        if (MAX_ARCHIVE_SIZE < offset) {
+            fprintf(stderr, "ERROR: the archive is larger than 4 GB, use -l to create a large archive\n");
+            exit(EXIT_FAILURE);
+        }
+
+        ARCHIVEITEMDESCRIPTORPTR items = (ARCHIVEITEMDESCRIPTORPTR)malloc(State.Archive.Count * sizeof(ARCHIVEITEMDESCRIPTOR) + 1);
+
+        for (unsigned i = 0; i < State.Archive.Count; i++) {
+            items[i].Name = State.Items[i].Name;
+            items[i].Type = State.Items[i].Type;
+            items[i].Offset = (unsigned)State.Items[i].Offset;
+            items[i].Size = (unsigned)State.Items[i].Size;
+            items[i].Chunk = State.Items[i].Chunk;
+        }
+
+        unsigned* offsets = (unsigned*)malloc(State.Archive.Index * sizeof(unsigned) + 1);
 
-    Save(State.Items, State.Archive.Count, sizeof(ARCHIVEITEMDESCRIPTOR));
-    Save(State.Names.Names, 1, (unsigned)(State.Names.Next - State.Names.Names));
-    Save(State.Offsets, State.Archive.Index, sizeof(unsigned));
+        for (unsigned i = 0; i < State.Archive.Index; i++) { offsets[i] = (unsigned)State.Offsets[i]; }
 
-    fseek(State.Archive.File, sizeof(unsigned), SEEK_SET);
-    fwrite(&offset, 1, sizeof(unsigned), State.Archive.File);
+        Save(items, State.Archive.Count, sizeof(ARCHIVEITEMDESCRIPTOR));
+        Save(State.Names.Names, 1, (unsigned)(State.Names.Next - State.Names.Names));
+        Save(offsets, State.Archive.Index, sizeof(unsigned));
+
+        free(items);
+        free(offsets);
+
+        const unsigned value = (unsigned)offset;
+
+        fseek(State.Archive.File, sizeof(unsigned), SEEK_SET);
+        fwrite(&value, 1, sizeof(unsigned), State.Archive.File);
+    }
 
     if (!State.IsSilent) {
         printf("\n");
@@ -75,6 +134,10 @@ void Release() {
 
     fclose(State.Archive.File);
 
+    if (State.Statistics.Mode != STATISTICSMODE_NONE) { PrintStatistics(); }
+
+    ReleaseArchives();
+
     State.Archive.Count = 0;
 }
 
@@ -84,12 +147,14 @@ int main(int argc, char* argv[]) {
 
     int block = DEFAULT_BLOCK_SIZE;
     int flatten = FALSE, subdirs = TRUE;
+    int scanners = 1;
 
     int indx = 1;
     for (; indx < argc; indx++) {
         if (argv[indx][0] != '-') { break; }
 
         switch (argv[indx][1]) {
+        case 'a': { State.IsAutomatic = TRUE; break; }
         case 'b': {
             block = atoi(&argv[indx][2]);
 
@@ -97,7 +162,30 @@ int main(int argc, char* argv[]) {
 
             break;
         }
+        case 'c': {
+            if (_strcmpi(&argv[indx][2], "lz4") == 0) { State.Codec = ARCHIVEITEMTYPE_LZ4; }
+            else if (_strcmpi(&argv[indx][2], "zlib") == 0) { State.Codec = ARCHIVEITEMTYPE_COMPRESSED; }
+            else { indx = argc - 1; }
+
+            break;
+        }
+        case 'd': { State.SkipDeduplication = TRUE; break; }
         case 'f': { flatten = TRUE; break; }
+        case 'j': {
+            int threads = atoi(&argv[indx][2]);
+
+            if (threads <= 0) {
+                SYSTEM_INFO info;
+                GetSystemInfo(&info);
+
+                threads = info.dwNumberOfProcessors;
+            }
+
+            State.Pipeline.ThreadCount = min(MAX_PIPELINE_THREAD_COUNT, threads);
+
+            break;
+        }
+        case 'l': { State.IsLarge = TRUE; break; }
         case 'm': {
             State.Compression = atoi(&argv[indx][2]);
             State.Compression = min(Z_BEST_COMPRESSION, max(Z_NO_COMPRESSION, State.Compression));
@@ -107,6 +195,14 @@ int main(int argc, char* argv[]) {
         case 'n': { State.SkipExtraction = TRUE; break; }
         case 'q': { State.IsSilent = TRUE; break; }
         case 's': { subdirs = 0; break; }
+        case 't': {
+            scanners = atoi(&argv[indx][2]);
+            scanners = min(MAX_SCANNER_THREAD_COUNT, max(1, scanners));
+
+            break;
+        }
+        case 'u': { State.IsUpdate = TRUE; break; }
+        case 'v': { State.Statistics.Mode = AcquireStatisticsMode(&argv[indx][2]); break; }
         default: { indx = argc - 1; break; }
         }
     }
@@ -116,11 +212,20 @@ int main(int argc, char* argv[]) {
         exit(EXIT_FAILURE);
     }
 
+    InitializeStatistics(State.Statistics.Mode);
+
     Initialize(argv[indx]);
 
+    if (State.Pipeline.ThreadCount > 1) { InitializePipeline(State.Pipeline.ThreadCount); }
+
+    InitializeScanner(scanners);
+
     for (indx = indx + 1; indx < argc; indx++) { ArchivePath(argv[indx], "", "*", block, subdirs, flatten); }
 
+    ReleaseScanner();
+
     Release();
+    ReleasePipeline();
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,156 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "State.hxx"
+
+#include <zlib.h>
+
+void InitializePipeline(const unsigned threads) {
+    State.Pipeline.IsActive = TRUE;
+    State.Pipeline.ThreadCount = threads;
+
+    State.Pipeline.Next = 0;
+    State.Pipeline.Count = 0;
+    State.Pipeline.Pending = CreateSemaphoreA(NULL, 0, MAXLONG, NULL);
+
+    State.Pipeline.SlotCount = threads * PIPELINE_SLOT_MULTIPLIER;
+    State.Pipeline.Slots = (PIPELINESLOTPTR)malloc(State.Pipeline.SlotCount * sizeof(PIPELINESLOT));
+
+    for (unsigned i = 0; i < State.Pipeline.SlotCount; i++) {
+        State.Pipeline.Slots[i].Event = CreateEventA(NULL, FALSE, FALSE, NULL);
+        State.Pipeline.Slots[i].Capacity = 0;
+        State.Pipeline.Slots[i].In = NULL;
+        State.Pipeline.Slots[i].Out = NULL;
+    }
+
+    for (unsigned i = 0; i < threads; i++) {
+        State.Pipeline.Threads[i] = CreateThread(NULL, 0, CompressArchiveFileBlocks, NULL, 0, NULL);
+    }
+}
+
+void ReleasePipeline(void) {
+    if (!State.Pipeline.IsActive) { return; }
+
+    State.Pipeline.IsActive = FALSE;
+
+    ReleaseSemaphore(State.Pipeline.Pending, State.Pipeline.ThreadCount, NULL);
+
+    for (unsigned i = 0; i < State.Pipeline.ThreadCount; i++) {
+        WaitForSingleObject(State.Pipeline.Threads[i], INFINITE);
+        CloseHandle(State.Pipeline.Threads[i]);
+    }
+
+    for (unsigned i = 0; i < State.Pipeline.SlotCount; i++) {
+        CloseHandle(State.Pipeline.Slots[i].Event);
+
+        free(State.Pipeline.Slots[i].In);
+        free(State.Pipeline.Slots[i].Out);
+    }
+
+    free(State.Pipeline.Slots);
+
+    CloseHandle(State.Pipeline.Pending);
+}
+
+static void WriteArchiveFileBlock(const unsigned indx, size_t* write) {
+    PIPELINESLOTPTR slot = &State.Pipeline.Slots[indx % State.Pipeline.SlotCount];
+
+    WaitForSingleObject(slot->Event, INFINITE);
+
+    AppendArchiveOffset(_ftelli64(State.Archive.File));
+
+    const long long start = AcquireStatisticsTime();
+
+    fwrite(slot->Out, 1, slot->Length, State.Archive.File);
+
+    ReleaseStatisticsTime(STATISTICSPHASE_WRITE, start, slot->Length);
+
+    *write = *write + slot->Length;
+}
+
+// NOTE:
+// The calling thread reads the blocks and writes them out in order, while the worker threads compress them.
+// Block (n) uses slot (n % SlotCount), and it is only read once block (n - SlotCount) has been written,
+// so the archive is byte-identical to the one produced by the serial code path.
+void CompressArchiveFile(void* file, const int block, size_t* read, size_t* write) {
+    // All the slots are idle between files, so they can be resized safely.
+    for (unsigned i = 0; i < State.Pipeline.SlotCount; i++) {
+        if (State.Pipeline.Slots[i].Capacity < (unsigned)block) {
+            free(State.Pipeline.Slots[i].In);
+            free(State.Pipeline.Slots[i].Out);
+
+            State.Pipeline.Slots[i].Capacity = block;
+            State.Pipeline.Slots[i].In = (byte*)malloc(block);
+            State.Pipeline.Slots[i].Out = (byte*)malloc(AcquireArchiveBlockBound(block));
+        }
+    }
+
+    unsigned completed = State.Pipeline.Count;
+
+    while (true) {
+        const int end = State.SkipExtraction
+            ? feof((FILE*)file) : gzeof((gzFile)file);
+
+        if (end) { break; }
+
+        if (State.Pipeline.Count - completed == State.Pipeline.SlotCount) {
+            WriteArchiveFileBlock(completed, write);
+            completed = completed + 1;
+        }
+
+        PIPELINESLOTPTR slot = &State.Pipeline.Slots[State.Pipeline.Count % State.Pipeline.SlotCount];
+
+        const long long start = AcquireStatisticsTime();
+
+        slot->Size = State.SkipExtraction
+            ? fread(slot->In, 1, block, (FILE*)file)
+            : gzread((gzFile)file, slot->In, block);
+
+        ReleaseStatisticsTime(STATISTICSPHASE_READ, start, slot->Size);
+
+        *read = *read + slot->Size;
+
+        State.Pipeline.Count = State.Pipeline.Count + 1;
+
+        ReleaseSemaphore(State.Pipeline.Pending, 1, NULL);
+    }
+
+    for (; completed != State.Pipeline.Count; completed++) { WriteArchiveFileBlock(completed, write); }
+}
+
+DWORD WINAPI CompressArchiveFileBlocks(LPVOID parameter) {
+    while (true) {
+        WaitForSingleObject(State.Pipeline.Pending, INFINITE);
+
+        if (!State.Pipeline.IsActive) { break; }
+
+        const unsigned indx = (unsigned)InterlockedIncrement(&State.Pipeline.Next) - 1;
+
+        PIPELINESLOTPTR slot = &State.Pipeline.Slots[indx % State.Pipeline.SlotCount];
+
+        slot->Length = CompressArchiveBlock(slot->Out, AcquireArchiveBlockBound(slot->Capacity), slot->In, (unsigned)slot->Size);
+
+        SetEvent(slot->Event);
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Base.hxx"
+
+#define MAX_PIPELINE_THREAD_COUNT   64
+#define PIPELINE_SLOT_MULTIPLIER    4
+
+typedef struct PipelineSlot {
+    HANDLE                  Event;      // Signaled once the block is compressed.
+    unsigned                Capacity;
+    size_t                  Size;
+    unsigned long           Length;
+    byte*                   In;
+    byte*                   Out;
+} PIPELINESLOT, * PIPELINESLOTPTR;
+
+typedef struct Pipeline {
+    int                     IsActive;
+    unsigned                ThreadCount;
+    HANDLE                  Threads[MAX_PIPELINE_THREAD_COUNT];
+
+    HANDLE                  Pending;    // Counts the blocks that are ready to be compressed.
+    volatile LONG           Next;
+    unsigned                Count;      // Total blocks submitted.
+
+    unsigned                SlotCount;
+    PIPELINESLOTPTR         Slots;
+} PIPELINE, * PIPELINEPTR;
+
+void InitializePipeline(const unsigned threads);
+void ReleasePipeline(void);
+
+void CompressArchiveFile(void* file, const int block, size_t* read, size_t* write);
+DWORD WINAPI CompressArchiveFileBlocks(LPVOID parameter);
\ No newline at end of file
@@ -0,0 +1,178 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "State.hxx"
+
+#include <io.h>
+
+void InitializeScanner(const unsigned threads) {
+    State.Scanner.IsActive = TRUE;
+    State.Scanner.ThreadCount = threads;
+
+    State.Scanner.Pending = CreateSemaphoreA(NULL, 0, MAXLONG, NULL);
+    InitializeCriticalSection(&State.Scanner.Lock);
+
+    State.Scanner.Head = NULL;
+    State.Scanner.Tail = NULL;
+
+    for (unsigned i = 0; i < threads; i++) {
+        State.Scanner.Threads[i] = CreateThread(NULL, 0, ScanDirectories, NULL, 0, NULL);
+    }
+}
+
+void ReleaseScanner(void) {
+    if (!State.Scanner.IsActive) { return; }
+
+    State.Scanner.IsActive = FALSE;
+
+    ReleaseSemaphore(State.Scanner.Pending, State.Scanner.ThreadCount, NULL);
+
+    for (unsigned i = 0; i < State.Scanner.ThreadCount; i++) {
+        WaitForSingleObject(State.Scanner.Threads[i], INFINITE);
+        CloseHandle(State.Scanner.Threads[i]);
+    }
+
+    DeleteCriticalSection(&State.Scanner.Lock);
+    CloseHandle(State.Scanner.Pending);
+}
+
+// NOTE:
+// The directory is queued to be listed by the scanner threads,
+// the caller waits for its event before walking the entries.
+SCANNERDIRECTORYPTR AcquireScannerDirectory(const char* path, const char* pattern, const int recursive) {
+    SCANNERDIRECTORYPTR directory = (SCANNERDIRECTORYPTR)malloc(sizeof(SCANNERDIRECTORY));
+
+    directory->Path = _strdup(path);
+    directory->Pattern = pattern;
+    directory->IsRecursive = recursive;
+
+    directory->Event = CreateEventA(NULL, TRUE, FALSE, NULL);
+    directory->Result = 0;
+
+    directory->Count = 0;
+    directory->Capacity = 0;
+    directory->Entries = NULL;
+
+    directory->Next = NULL;
+
+    EnterCriticalSection(&State.Scanner.Lock);
+
+    if (State.Scanner.Tail == NULL) { State.Scanner.Head = directory; }
+    else { State.Scanner.Tail->Next = directory; }
+
+    State.Scanner.Tail = directory;
+
+    LeaveCriticalSection(&State.Scanner.Lock);
+
+    ReleaseSemaphore(State.Scanner.Pending, 1, NULL);
+
+    return directory;
+}
+
+void ReleaseScannerDirectory(SCANNERDIRECTORYPTR directory) {
+    for (unsigned i = 0; i < directory->Count; i++) { free(directory->Entries[i].Name); }
+
+    CloseHandle(directory->Event);
+
+    free(directory->Entries);
+    free(directory->Path);
+    free(directory);
+}
+
+// NOTE:
+// The entries are sorted, so that the files are added in the same order regardless of the file system,
+// and the subdirectories are queued right away, so that they are listed while the files are being compressed.
+void ScanDirectory(SCANNERDIRECTORYPTR directory) {
+    char file[MAX_FILE_NAME_LENGTH];
+    sprintf(file, "%s%s", directory->Path, directory->Pattern);
+
+    // NOTE: The listing already holds the size and the time of each file, so the files are not examined again.
+    _finddatai64_t context;
+    intptr_t handle = _findfirsti64(file, &context);
+
+    if (handle == -1) {
+        directory->Result = errno;
+
+        SetEvent(directory->Event);
+
+        return;
+    }
+
+    do {
+        if (context.attrib & _A_SUBDIR) {
+            if (strcmp(context.name, ".") == 0 || strcmp(context.name, "..") == 0 || !directory->IsRecursive) { continue; }
+        }
+
+        if (directory->Capacity <= directory->Count) {
+            directory->Capacity = max(MIN_SCANNER_ENTRY_COUNT, directory->Capacity * 2);
+            directory->Entries = (SCANNERENTRYPTR)realloc(directory->Entries, directory->Capacity * sizeof(SCANNERENTRY));
+        }
+
+        directory->Entries[directory->Count].Name = _strdup(context.name);
+        directory->Entries[directory->Count].Directory = (context.attrib & _A_SUBDIR) ? (SCANNERDIRECTORYPTR)directory : NULL;
+        directory->Entries[directory->Count].Size = context.size;
+        directory->Entries[directory->Count].Time = context.time_write;
+
+        directory->Count = directory->Count + 1;
+    } while (_findnexti64(handle, &context) == 0);
+
+    _findclose(handle);
+
+    qsort(directory->Entries, directory->Count, sizeof(SCANNERENTRY), CompareScannerEntries);
+
+    for (unsigned i = 0; i < directory->Count; i++) {
+        if (directory->Entries[i].Directory == NULL) { continue; }
+
+        char path[MAX_FILE_NAME_LENGTH];
+        sprintf(path, "%s%s\\", directory->Path, directory->Entries[i].Name);
+
+        directory->Entries[i].Directory = AcquireScannerDirectory(path, directory->Pattern, directory->IsRecursive);
+    }
+
+    SetEvent(directory->Event);
+}
+
+int CompareScannerEntries(const void* a, const void* b) {
+    return strcmp(((SCANNERENTRYPTR)a)->Name, ((SCANNERENTRYPTR)b)->Name);
+}
+
+DWORD WINAPI ScanDirectories(LPVOID parameter) {
+    while (true) {
+        WaitForSingleObject(State.Scanner.Pending, INFINITE);
+
+        if (!State.Scanner.IsActive) { break; }
+
+        EnterCriticalSection(&State.Scanner.Lock);
+
+        SCANNERDIRECTORYPTR directory = State.Scanner.Head;
+
+        State.Scanner.Head = directory->Next;
+
+        if (State.Scanner.Head == NULL) { State.Scanner.Tail = NULL; }
+
+        LeaveCriticalSection(&State.Scanner.Lock);
+
+        ScanDirectory(directory);
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
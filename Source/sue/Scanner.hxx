@@ -0,0 +1,71 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Base.hxx"
+
+#define MAX_SCANNER_THREAD_COUNT    64
+
+#define MIN_SCANNER_ENTRY_COUNT     64
+
+typedef struct ScannerEntry {
+    char*                       Name;
+    struct ScannerDirectory*    Directory;  // The subdirectory, or NULL for a file.
+    unsigned long long          Size;       // The size of the file, as listed.
+    long long                   Time;       // The last write time of the file, as listed.
+} SCANNERENTRY, * SCANNERENTRYPTR;
+
+typedef struct ScannerDirectory {
+    char*                       Path;
+    const char*                 Pattern;
+    int                         IsRecursive;
+
+    HANDLE                      Event;      // Signaled once the directory is listed.
+    int                         Result;     // The errno of the failed listing, or zero.
+
+    unsigned                    Count;
+    unsigned                    Capacity;
+    SCANNERENTRYPTR             Entries;    // Sorted by name.
+
+    struct ScannerDirectory*    Next;       // Next directory waiting to be listed.
+} SCANNERDIRECTORY, * SCANNERDIRECTORYPTR;
+
+typedef struct Scanner {
+    int                         IsActive;
+    unsigned                    ThreadCount;
+    HANDLE                      Threads[MAX_SCANNER_THREAD_COUNT];
+
+    HANDLE                      Pending;    // Counts the directories waiting to be listed.
+    CRITICAL_SECTION            Lock;
+    SCANNERDIRECTORYPTR         Head;
+    SCANNERDIRECTORYPTR         Tail;
+} SCANNER, * SCANNERPTR;
+
+void InitializeScanner(const unsigned threads);
+void ReleaseScanner(void);
+
+SCANNERDIRECTORYPTR AcquireScannerDirectory(const char* path, const char* pattern, const int recursive);
+void ReleaseScannerDirectory(SCANNERDIRECTORYPTR directory);
+void ScanDirectory(SCANNERDIRECTORYPTR directory);
+int CompareScannerEntries(const void* a, const void* b);
+DWORD WINAPI ScanDirectories(LPVOID parameter);
\ No newline at end of file
@@ -23,6 +23,8 @@ SOFTWARE.
 #pragma once
 
 #include "Archive.hxx"
+#include "Pipeline.hxx"
+#include "Statistics.hxx"
 
 #include <stdio.h>
 
@@ -30,18 +32,28 @@ SOFTWARE.
 
 #define MAX_FILE_NAME_LENGTH    256
 
-#define MAX_FILE_COUNT          2048
-
 #define MAX_CONTENT_IN_SIZE     0x40000
 #define MAX_CONTENT_OUT_SIZE    0x50000
 
-#define MAX_ARCHIVE_ITEM_COUNT  4096
+#define MIN_ARCHIVE_ITEM_COUNT      1024
+#define MIN_ARCHIVE_NAME_SIZE       (16 * 1024)
+#define MIN_ARCHIVE_OFFSET_COUNT    (16 * 1024)
+#define MIN_ARCHIVE_INDEX_COUNT     4096 /* Power of two. */
 
 typedef struct AppState {
     int                     Compression;                                    // 0x00411030
+    ARCHIVEITEMTYPE         Codec;
 
     int                     IsSilent;                                       // 0x00739138
     int                     SkipExtraction;                                 // 0x0073913c
+    int                     IsLarge;
+    int                     IsUpdate;
+    int                     SkipDeduplication;
+    int                     IsAutomatic;
+
+    PIPELINE                Pipeline;
+    SCANNER                 Scanner;
+    STATISTICS              Statistics;
 
     struct {
         FILE*               File;                                           // 0x00415130
@@ -49,6 +61,7 @@ typedef struct AppState {
         unsigned            Index;                                          // 0x00739140
         unsigned            Count;                                          // 0x00739144
         unsigned            Size;                                           // 0x0073914c
+        long long           Time;   // The last write time of the archive being updated.
     } Archive;
 
     struct {
@@ -56,14 +69,37 @@ typedef struct AppState {
         byte                Out[MAX_CONTENT_OUT_SIZE];                      // 0x00415134
     } Content;
 
+    // NOTE: The tables below grow as needed, so that the memory use follows the number of files and blocks.
     struct {
         char*               Next;                                           // 0x00411034
-        char                Names[MAX_FILE_COUNT * MAX_FILE_NAME_LENGTH];   // 0x006a5134
+        size_t              Capacity;
+        char*               Names;                                          // 0x006a5134
     } Names;
 
-    ARCHIVEITEMDESCRIPTOR   Items[MAX_ARCHIVE_ITEM_COUNT];                  // 0x00725138
+    // NOTE: The hashed items are chained in the buckets by the size of their file.
+    struct {
+        unsigned            Count;
+        unsigned            Capacity;
+        ARCHIVEITEMHASHPTR  Items;
 
-    long                    Offsets[MAX_FILE_COUNT * MAX_FILE_NAME_LENGTH]; // 0x004a5134
+        unsigned            BucketCount;
+        int*                Buckets;
+    } Hashes;
+
+    // NOTE: Open addressing table of the items by the lower case name, kept at most half full, for the update lookups.
+    struct {
+        unsigned            Count;
+        unsigned            Capacity;
+        unsigned*           Hashes;
+        int*                Items;
+    } Index;
+
+    // NOTE: The items and the offsets are kept 64-bit, and narrowed on save unless the archive is large.
+    unsigned                ItemCapacity;
+    ARCHIVEITEMDESCRIPTOR64PTR Items;                                       // 0x00725138
+
+    unsigned                OffsetCapacity;
+    long long*              Offsets;                                        // 0x004a5134
 } APPSTATE, * APPSTATEPTR;
 
 extern APPSTATE State;
\ No newline at end of file
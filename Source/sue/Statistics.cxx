@@ -0,0 +1,213 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "State.hxx"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+void InitializeStatistics(const STATISTICSMODE mode) {
+    State.Statistics.Mode = mode;
+
+    // The report is the only output in JSON mode, so that it can be parsed.
+    if (mode == STATISTICSMODE_JSON) { State.IsSilent = TRUE; }
+
+    QueryPerformanceFrequency(&State.Statistics.Frequency);
+
+    ZeroMemory(State.Statistics.Phases, STATISTICSPHASE_COUNT * sizeof(STATISTICSCOUNTER));
+
+    State.Statistics.Start = AcquireStatisticsTime();
+}
+
+STATISTICSMODE AcquireStatisticsMode(const char* value) {
+    if (_strcmpi(value, "trace") == 0) { return STATISTICSMODE_TRACE; }
+    if (_strcmpi(value, "json") == 0) { return STATISTICSMODE_JSON; }
+
+    return STATISTICSMODE_SUMMARY;
+}
+
+const char* AcquireStatisticsPhaseName(const STATISTICSPHASE phase) {
+    switch (phase) {
+    case STATISTICSPHASE_SCAN: { return "scan"; }
+    case STATISTICSPHASE_HASH: { return "hash"; }
+    case STATISTICSPHASE_READ: { return "read"; }
+    case STATISTICSPHASE_COMPRESS: { return "compress"; }
+    case STATISTICSPHASE_WRITE: { return "write"; }
+    case STATISTICSPHASE_INDEX: { return "index"; }
+    }
+
+    return "unknown";
+}
+
+// NOTE: Zero while the statistics are off, so that the timed code only pays for a branch.
+long long AcquireStatisticsTime(void) {
+    if (State.Statistics.Mode == STATISTICSMODE_NONE) { return 0; }
+
+    LARGE_INTEGER value;
+    QueryPerformanceCounter(&value);
+
+    return value.QuadPart;
+}
+
+void ReleaseStatisticsTime(const STATISTICSPHASE phase, const long long start, const unsigned long long bytes) {
+    if (State.Statistics.Mode == STATISTICSMODE_NONE) { return; }
+
+    STATISTICSCOUNTERPTR counter = &State.Statistics.Phases[phase];
+
+    InterlockedExchangeAdd64(&counter->Count, 1);
+    InterlockedExchangeAdd64(&counter->Bytes, (LONGLONG)bytes);
+    InterlockedExchangeAdd64(&counter->Time, AcquireStatisticsTime() - start);
+}
+
+double AcquireStatisticsSeconds(const long long time) {
+    return (double)time / (double)State.Statistics.Frequency.QuadPart;
+}
+
+// NOTE: The size the item takes within the archive, the blocks of a compressed item are followed by the offset of its end.
+// NOTE: The identical files share the content stored for the first of them, so the items are ordered by their content.
+int CompareArchiveItemContent(const void* a, const void* b) {
+    const ARCHIVEITEMDESCRIPTOR64PTR x = &State.Items[*(const int*)a];
+    const ARCHIVEITEMDESCRIPTOR64PTR y = &State.Items[*(const int*)b];
+
+    if (x->Type != y->Type) { return x->Type < y->Type ? -1 : 1; }
+    if (x->Offset != y->Offset) { return x->Offset < y->Offset ? -1 : 1; }
+    if (x->Size != y->Size) { return x->Size < y->Size ? -1 : 1; }
+
+    return *(const int*)a - *(const int*)b;
+}
+
+// Marks the items that share the content of an earlier one.
+int* AcquireArchiveItemShares(void) {
+    const unsigned count = State.Archive.Count;
+
+    int* order = (int*)malloc(count * sizeof(int));
+    int* result = (int*)calloc(count, sizeof(int));
+
+    for (unsigned i = 0; i < count; i++) { order[i] = i; }
+
+    qsort(order, count, sizeof(int), CompareArchiveItemContent);
+
+    for (unsigned i = 1; i < count; i++) {
+        const ARCHIVEITEMDESCRIPTOR64PTR x = &State.Items[order[i - 1]];
+        const ARCHIVEITEMDESCRIPTOR64PTR y = &State.Items[order[i]];
+
+        if (x->Type == y->Type && x->Offset == y->Offset && x->Size == y->Size) { result[order[i]] = TRUE; }
+    }
+
+    free(order);
+
+    return result;
+}
+
+unsigned long long AcquireArchiveItemStoredSize(const unsigned indx, const int* shares) {
+    if (shares[indx]) { return 0; }
+
+    if (State.Items[indx].Type == ARCHIVEITEMTYPE_PACKED) { return State.Items[indx].Size; }
+
+    if (State.Items[indx].Chunk == 0) { return 0; }
+
+    const unsigned long long position = State.Items[indx].Offset;
+    const unsigned long long count = (State.Items[indx].Size + State.Items[indx].Chunk - 1) / State.Items[indx].Chunk;
+
+    return State.Offsets[position + count] - State.Offsets[position];
+}
+
+void PrintStatisticsString(const char* value) {
+    printf("\"");
+
+    for (; *value != NULL; value++) {
+        if (*value == '\\' || *value == '"') { printf("\\"); }
+
+        printf("%c", *value);
+    }
+
+    printf("\"");
+}
+
+void PrintStatistics(void) {
+    const double total = AcquireStatisticsSeconds(AcquireStatisticsTime() - State.Statistics.Start);
+
+    const unsigned long long read = State.Statistics.Phases[STATISTICSPHASE_READ].Bytes;
+    const unsigned long long written = State.Statistics.Phases[STATISTICSPHASE_WRITE].Bytes;
+
+    if (State.Statistics.Mode == STATISTICSMODE_JSON) {
+        printf("{\n  \"seconds\": %.6f,\n  \"read\": %llu,\n  \"written\": %llu,\n", total, read, written);
+
+        printf("  \"phases\": [\n");
+
+        for (unsigned i = 0; i < STATISTICSPHASE_COUNT; i++) {
+            STATISTICSCOUNTERPTR counter = &State.Statistics.Phases[i];
+
+            printf("    { \"name\": \"%s\", \"count\": %lld, \"bytes\": %lld, \"seconds\": %.6f }%s\n",
+                AcquireStatisticsPhaseName((STATISTICSPHASE)i), counter->Count, counter->Bytes,
+                AcquireStatisticsSeconds(counter->Time), i + 1 < STATISTICSPHASE_COUNT ? "," : "");
+        }
+
+        printf("  ],\n  \"items\": [\n");
+
+        int* shares = AcquireArchiveItemShares();
+
+        for (unsigned i = 0; i < State.Archive.Count; i++) {
+            const unsigned long long size = State.Items[i].Size;
+            const unsigned long long stored = AcquireArchiveItemStoredSize(i, shares);
+
+            printf("    { \"name\": ");
+            PrintStatisticsString(&State.Names.Names[State.Items[i].Name]);
+            printf(", \"type\": %d, \"size\": %llu, \"stored\": %llu, \"ratio\": %.4f }%s\n",
+                State.Items[i].Type, size, stored, size == 0 ? 1.0 : (double)stored / (double)size,
+                i + 1 < State.Archive.Count ? "," : "");
+        }
+
+        free(shares);
+
+        printf("  ]\n}\n");
+
+        return;
+    }
+
+    printf("\nPhase            Count            Bytes      Seconds\n");
+
+    for (unsigned i = 0; i < STATISTICSPHASE_COUNT; i++) {
+        STATISTICSCOUNTERPTR counter = &State.Statistics.Phases[i];
+
+        printf("%-10s %11lld %16lld %12.6f\n", AcquireStatisticsPhaseName((STATISTICSPHASE)i),
+            counter->Count, counter->Bytes, AcquireStatisticsSeconds(counter->Time));
+    }
+
+    printf("\nRead %llu bytes, wrote %llu bytes in %.6f seconds\n", read, written, total);
+
+    if (State.Statistics.Mode != STATISTICSMODE_TRACE) { return; }
+
+    printf("\n");
+
+    int* shares = AcquireArchiveItemShares();
+
+    for (unsigned i = 0; i < State.Archive.Count; i++) {
+        const unsigned long long size = State.Items[i].Size;
+        const unsigned long long stored = AcquireArchiveItemStoredSize(i, shares);
+
+        printf("%d %s %llu->%llu %.1f%%\n", State.Items[i].Type, &State.Names.Names[State.Items[i].Name],
+            size, stored, size == 0 ? 100.0 : 100.0 * (double)stored / (double)size);
+    }
+
+    free(shares);
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Base.hxx"
+
+typedef enum StatisticsMode {
+    STATISTICSMODE_NONE         = 0,
+    STATISTICSMODE_SUMMARY      = 1, // Phase totals
+    STATISTICSMODE_TRACE        = 2, // Phase totals, followed by a line per item
+    STATISTICSMODE_JSON         = 3, // Phase totals and items, as JSON
+    STATISTICSMODE_FORCE_DWORD  = 0x7FFFFFFF
+} STATISTICSMODE, * STATISTICSMODEPTR;
+
+typedef enum StatisticsPhase {
+    STATISTICSPHASE_SCAN        = 0, // Waiting for the directory listings
+    STATISTICSPHASE_HASH        = 1, // Reading the files to find the identical ones
+    STATISTICSPHASE_READ        = 2, // Reading the files being compressed
+    STATISTICSPHASE_COMPRESS    = 3, // Deflating or encoding the blocks
+    STATISTICSPHASE_WRITE       = 4, // Writing the archive content
+    STATISTICSPHASE_INDEX       = 5, // Loading and saving the archive tables
+    STATISTICSPHASE_COUNT       = 6,
+    STATISTICSPHASE_FORCE_DWORD = 0x7FFFFFFF
+} STATISTICSPHASE, * STATISTICSPHASEPTR;
+
+// NOTE:
+// The blocks are compressed on the pipeline threads, so the counters only change with the interlocked operations,
+// and the compression time is the sum over the threads.
+typedef struct StatisticsCounter {
+    volatile LONGLONG       Count;
+    volatile LONGLONG       Bytes;
+    volatile LONGLONG       Time;
+} STATISTICSCOUNTER, * STATISTICSCOUNTERPTR;
+
+typedef struct Statistics {
+    STATISTICSMODE          Mode;
+    LARGE_INTEGER           Frequency;
+    long long               Start;
+    STATISTICSCOUNTER       Phases[STATISTICSPHASE_COUNT];
+} STATISTICS, * STATISTICSPTR;
+
+void InitializeStatistics(const STATISTICSMODE mode);
+STATISTICSMODE AcquireStatisticsMode(const char* value);
+const char* AcquireStatisticsPhaseName(const STATISTICSPHASE phase);
+long long AcquireStatisticsTime(void);
+void ReleaseStatisticsTime(const STATISTICSPHASE phase, const long long start, const unsigned long long bytes);
+double AcquireStatisticsSeconds(const long long time);
+int CompareArchiveItemContent(const void* a, const void* b);
+int* AcquireArchiveItemShares(void);
+unsigned long long AcquireArchiveItemStoredSize(const unsigned indx, const int* shares);
+void PrintStatisticsString(const char* value);
+void PrintStatistics(void);
\ No newline at end of file
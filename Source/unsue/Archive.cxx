@@ -22,57 +22,290 @@ SOFTWARE.
 
 #include "State.hxx"
 
+#include <ctype.h>
+#include <io.h>
+#include <lz4.h>
 #include <stdio.h>
 #include <zlib.h>
 
-// 0x004014a0
-bool OpenArchive(const char* path)
+bool MountArchive(const char* path, const int priority)
 {
-    int indx = -1;
+    const size_t length = strlen(path);
+
+    if (length == 0) { return false; }
+
+    // NOTE: Same as with the packer, directory names end with a backslash.
+    if (path[length - 1] == '\\' || path[length - 1] == '/') { return OpenArchiveDirectory(path, priority); }
+
+    return OpenArchive(path, priority);
+}
 
-    for (int i = 0; i < MAX_ARCHIVE_COUNT; i++)
+unsigned AcquireArchive(void)
+{
+    if (State.ArchiveCount == State.ArchiveCapacity)
     {
-        if (!State.Archives[i].IsActive) { indx = i; break; }
+        State.ArchiveCapacity = max(MIN_ARCHIVE_COUNT, State.ArchiveCapacity * 2);
+        State.Archives = (ARCHIVEPTR)realloc(State.Archives, State.ArchiveCapacity * sizeof(ARCHIVE));
     }
 
-    if (indx == -1) { return false; }
+    const unsigned indx = State.ArchiveCount;
+
+    State.Archives[indx].IsActive = false;
+    State.Archives[indx].Priority = 0;
+    State.Archives[indx].Path[0] = NULL;
+    State.Archives[indx].Offsets = NULL;
+    State.Archives[indx].Names = NULL;
+    State.Archives[indx].Details = NULL;
+    State.Archives[indx].File = File();
+    State.Archives[indx].Content = NULL;
+    State.Archives[indx].Window.Content = NULL;
+
+    State.ArchiveCount = State.ArchiveCount + 1;
+
+    return indx;
+}
+
+// 0x004014a0
+bool OpenArchive(const char* path, const int priority)
+{
+    if (MAX_ARCHIVE_PATH_LENGTH <= strlen(path)) { return false; }
 
     File file;
-    ARCHIVEHEADER header;
+    ARCHIVEHEADER64 header;
+
+    // NOTE: The extraction reads the archive front to back, while the lookups of the library read it at the scattered offsets.
+    const FILEOPENOPTIONS options = (FILEOPENOPTIONS)(FILEOPENOPTIONS_READ | (State.IsSequential ? FILEOPENOPTIONS_SEQUENTIAL : FILEOPENOPTIONS_RANDOM));
 
-    file.Open(path, FILEOPENOPTIONS_READ);
-    file.Read(&header, sizeof(ARCHIVEHEADER));
+    if (!file.Open(path, options)) { return false; }
 
-    if (header.Magic != ARCHIVE_MAGIC)
+    if (!ReadArchiveHeader(&file, &header))
     {
         file.Close();
 
         return false;
     }
 
-    file.SetPosition(header.Offset, FILE_CURRENT);
+    const unsigned indx = AcquireArchive();
 
-    unsigned count = 0;
-    ARCHIVEITEMDESCRIPTORPTR files = (ARCHIVEITEMDESCRIPTORPTR)ReadArchiveDetails(&file, &count);
-    char* names = (char*)ReadArchiveDetails(&file, NULL);
-    unsigned* offsets = (unsigned*)ReadArchiveDetails(&file, NULL);
+    strcpy(State.Archives[indx].Path, path);
 
-    for (unsigned i = 0; i < count; i++) { AcquireArchiveItem(&files[i], indx, names); }
+    State.Archives[indx].IsActive = true;
+    State.Archives[indx].Priority = priority;
 
-    free(files);
+    const long long start = AcquireStatisticsTime();
 
-    strcpy(State.Archives[indx].Path, path);
+    ARCHIVEDETAILSHEADER key;
+    AcquireArchiveDetailsKey(&file, header.Offset, &key);
 
-    State.Archives[indx].IsActive = true;
-    State.Archives[indx].File.Handle = INVALID_HANDLE_VALUE;
+    ARCHIVEDETAILSHEADERPTR details = State.IsIndexed ? OpenArchiveDetails(path, &key) : NULL;
+
+    ARCHIVEITEMDESCRIPTOR64PTR files = NULL;
+    unsigned long long* offsets = NULL;
+    unsigned* hashes = NULL;
+    char* names = NULL;
+
+    if (details != NULL)
+    {
+        // The tables are used in place, straight from the mapped sidecar file.
+        files = (ARCHIVEITEMDESCRIPTOR64PTR)((size_t)details + sizeof(ARCHIVEDETAILSHEADER));
+        offsets = (unsigned long long*)((size_t)files + details->Count * sizeof(ARCHIVEITEMDESCRIPTOR64));
+        hashes = (unsigned*)((size_t)offsets + details->OffsetCount * sizeof(unsigned long long));
+        names = (char*)((size_t)hashes + details->Count * sizeof(unsigned));
+
+        key.Count = details->Count;
+    }
+    else
+    {
+        file.SetPosition(header.Offset, FILE_CURRENT);
+
+        if (header.Magic == ARCHIVE_MAGIC_64)
+        {
+            files = (ARCHIVEITEMDESCRIPTOR64PTR)ReadArchiveDetails(&file, &key.Count, NULL);
+            names = (char*)ReadArchiveDetails(&file, NULL, &key.NameSize);
+            offsets = (unsigned long long*)ReadArchiveDetails(&file, &key.OffsetCount, NULL);
+        }
+        else
+        {
+            ARCHIVEITEMDESCRIPTORPTR items = (ARCHIVEITEMDESCRIPTORPTR)ReadArchiveDetails(&file, &key.Count, NULL);
+            names = (char*)ReadArchiveDetails(&file, NULL, &key.NameSize);
+            unsigned* values = (unsigned*)ReadArchiveDetails(&file, &key.OffsetCount, NULL);
+
+            // The regular archive is widened, so that the rest of the code only deals with 64-bit offsets.
+            files = AcquireArchiveItemDescriptors(items, key.Count);
+            offsets = AcquireArchiveOffsets(values, key.OffsetCount);
+        }
+
+        hashes = (unsigned*)malloc(key.Count * sizeof(unsigned) + 1);
+
+        for (unsigned i = 0; i < key.Count; i++)
+        {
+            hashes[i] = AcquireArchiveItemHash((const char*)((size_t)names + (size_t)files[i].Name));
+        }
+
+        if (State.IsIndexed) { SaveArchiveDetails(path, &key, files, offsets, hashes, names); }
+    }
+
+    State.Archives[indx].Details = details;
     State.Archives[indx].Offsets = offsets;
     State.Archives[indx].Names = names;
 
+    for (unsigned i = 0; i < key.Count; i++) { AcquireArchiveItem(&files[i], indx, names, hashes[i]); }
+
+    InitializeArchiveItemChunkBuffers(files, key.Count);
+
+    if (details == NULL)
+    {
+        free(files);
+        free(hashes);
+    }
+
+    // NOTE: Falls back to the regular reads if the archive cannot be mapped.
+    if (State.IsMapped) { State.Archives[indx].Content = file.Map(); }
+
+    // The content is read through the archive's own file with the positioned reads,
+    // so that the concurrent readers do not share a file position.
+    if (State.Archives[indx].Content == NULL) { State.Archives[indx].File = file; }
+    else { file.Close(); }
+
+    ReleaseStatisticsTime(STATISTICSPHASE_INDEX, start, 0);
+
     return true;
 }
 
+bool OpenArchiveDirectory(const char* path, const int priority)
+{
+    // NOTE: The loose files are opened by the archive path followed by the item name.
+    if (MAX_ARCHIVE_PATH_LENGTH <= strlen(path) + 1) { return false; }
+
+    ARCHIVEDIRECTORY directory;
+
+    directory.Count = 0;
+    directory.Capacity = MIN_ARCHIVE_DIRECTORY_ITEM_COUNT;
+    directory.Items = (ARCHIVEITEMDESCRIPTOR64PTR)malloc(directory.Capacity * sizeof(ARCHIVEITEMDESCRIPTOR64));
+
+    directory.NameSize = 0;
+    directory.NameCapacity = MIN_ARCHIVE_DIRECTORY_NAME_SIZE;
+    directory.Names = (char*)malloc(directory.NameCapacity);
+
+    char root[MAX_PATH];
+    strcpy(root, path);
+
+    {
+        const size_t length = strlen(root);
+
+        if (root[length - 1] == '/') { root[length - 1] = '\\'; }
+    }
+
+    ReadArchiveDirectory(&directory, root, "");
+
+    const unsigned indx = AcquireArchive();
+
+    strcpy(State.Archives[indx].Path, root);
+
+    State.Archives[indx].IsActive = true;
+    State.Archives[indx].Priority = priority;
+    State.Archives[indx].Names = directory.Names;
+
+    for (unsigned i = 0; i < directory.Count; i++)
+    {
+        AcquireArchiveItem(&directory.Items[i], indx, directory.Names,
+            AcquireArchiveItemHash(&directory.Names[directory.Items[i].Name]));
+    }
+
+    free(directory.Items);
+
+    return true;
+}
+
+void ReadArchiveDirectory(ARCHIVEDIRECTORYPTR directory, const char* path, const char* name)
+{
+    char file[MAX_PATH];
+    sprintf(file, "%s*", path);
+
+    _finddata_t context;
+    intptr_t handle = _findfirst(file, &context);
+
+    if (handle == -1) { return; }
+
+    char dir[MAX_PATH];
+    char tag[MAX_PATH];
+
+    do
+    {
+        if (strcmp(context.name, ".") == 0 || strcmp(context.name, "..") == 0) { continue; }
+
+        if (context.attrib & _A_SUBDIR)
+        {
+            sprintf(dir, "%s%s\\", path, context.name);
+            sprintf(tag, "%s%s\\", name, context.name);
+
+            ReadArchiveDirectory(directory, dir, tag);
+
+            continue;
+        }
+
+        sprintf(tag, "%s%s", name, context.name);
+
+        const unsigned length = (unsigned)strlen(tag) + 1;
+
+        if (MAX_ARCHIVE_PATH_LENGTH <= strlen(path) + length) { continue; }
+
+        if (directory->Count == directory->Capacity)
+        {
+            directory->Capacity = directory->Capacity * 2;
+            directory->Items = (ARCHIVEITEMDESCRIPTOR64PTR)realloc(directory->Items, directory->Capacity * sizeof(ARCHIVEITEMDESCRIPTOR64));
+        }
+
+        while (directory->NameCapacity < directory->NameSize + length)
+        {
+            directory->NameCapacity = directory->NameCapacity * 2;
+            directory->Names = (char*)realloc(directory->Names, directory->NameCapacity);
+        }
+
+        ARCHIVEITEMDESCRIPTOR64PTR item = &directory->Items[directory->Count];
+
+        item->Name = directory->NameSize;
+        item->Type = ARCHIVEITEMTYPE_FILE;
+        item->Offset = 0;
+        item->Size = (unsigned)context.size;
+        item->Chunk = 0;
+        item->Reserved = 0;
+
+        strcpy(&directory->Names[directory->NameSize], tag);
+
+        directory->NameSize = directory->NameSize + length;
+        directory->Count = directory->Count + 1;
+    } while (_findnext(handle, &context) == 0);
+
+    _findclose(handle);
+}
+
+bool ReadArchiveHeader(File* file, ARCHIVEHEADER64PTR header)
+{
+    ARCHIVEHEADER value;
+
+    if (file->Read(&value, sizeof(ARCHIVEHEADER)) != sizeof(ARCHIVEHEADER)) { return false; }
+
+    header->Magic = value.Magic;
+
+    if (value.Magic == ARCHIVE_MAGIC)
+    {
+        header->Version = 0;
+        header->Offset = value.Offset;
+
+        return true;
+    }
+
+    // NOTE: The large archive has the version where the regular one has the offset, followed by the 64-bit offset.
+    if (value.Magic != ARCHIVE_MAGIC_64 || value.Offset != ARCHIVE_VERSION_64) { return false; }
+
+    header->Version = value.Offset;
+
+    return file->Read(&header->Offset, sizeof(unsigned long long)) == sizeof(unsigned long long);
+}
+
 // 0x004015f0
-void* ReadArchiveDetails(File* file, unsigned* count)
+void* ReadArchiveDetails(File* file, unsigned* count, unsigned* size)
 {
     ARCHIVEDESCRIPTOR desc;
 
@@ -83,55 +316,276 @@ void* ReadArchiveDetails(File* file, unsigned* count)
     unsigned length = desc.Length * desc.Count;
     void* dst = malloc(length);
 
-    file->Read(src, desc.Size);
+    {
+        const long long start = AcquireStatisticsTime();
+
+        file->Read(src, desc.Size);
 
-    uncompress((Bytef*)dst, (uLong*)&length, src, desc.Size);
+        ReleaseStatisticsTime(STATISTICSPHASE_READ, start, desc.Size);
+    }
+
+    InflateArchiveItemContent(dst, length, src, desc.Size);
 
     if (count != NULL) { *count = desc.Count; }
+    if (size != NULL) { *size = desc.Length * desc.Count; }
 
     free(src);
 
     return dst;
 }
 
+ARCHIVEITEMDESCRIPTOR64PTR AcquireArchiveItemDescriptors(ARCHIVEITEMDESCRIPTORPTR items, const unsigned count)
+{
+    ARCHIVEITEMDESCRIPTOR64PTR result = (ARCHIVEITEMDESCRIPTOR64PTR)malloc(count * sizeof(ARCHIVEITEMDESCRIPTOR64) + 1);
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        result[i].Name = items[i].Name;
+        result[i].Type = items[i].Type;
+        result[i].Offset = items[i].Offset;
+        result[i].Size = items[i].Size;
+        result[i].Chunk = items[i].Chunk;
+        result[i].Reserved = 0;
+    }
+
+    free(items);
+
+    return result;
+}
+
+unsigned long long* AcquireArchiveOffsets(unsigned* offsets, const unsigned count)
+{
+    unsigned long long* result = (unsigned long long*)malloc(count * sizeof(unsigned long long) + 1);
+
+    for (unsigned i = 0; i < count; i++) { result[i] = offsets[i]; }
+
+    free(offsets);
+
+    return result;
+}
+
+void AcquireArchiveDetailsKey(File* file, const unsigned long long offset, ARCHIVEDETAILSHEADERPTR key)
+{
+    key->Magic = ARCHIVE_DETAILS_MAGIC;
+    key->Version = ARCHIVE_DETAILS_VERSION;
+
+    key->Size = file->Size();
+
+    const unsigned long long time = file->Time();
+
+    key->Time.dwLowDateTime = (DWORD)time;
+    key->Time.dwHighDateTime = (DWORD)(time >> 32);
+
+    key->Offset = offset;
+
+    key->Count = 0;
+    key->NameSize = 0;
+    key->OffsetCount = 0;
+    key->Reserved = 0;
+}
+
+ARCHIVEDETAILSHEADERPTR OpenArchiveDetails(const char* path, ARCHIVEDETAILSHEADERPTR key)
+{
+    char name[MAX_PATH];
+    sprintf(name, "%s%s", path, ARCHIVE_DETAILS_EXTENSION);
+
+    File file;
+
+    if (!file.Open(name, FILEOPENOPTIONS_READ)) { return NULL; }
+
+    const unsigned long long size = file.Size();
+
+    ARCHIVEDETAILSHEADERPTR result = sizeof(ARCHIVEDETAILSHEADER) <= size
+        ? (ARCHIVEDETAILSHEADERPTR)file.Map() : NULL;
+
+    file.Close();
+
+    if (result == NULL) { return NULL; }
+
+    // The details are only good for the very archive they were taken from.
+    if (result->Magic != key->Magic || result->Version != key->Version
+        || result->Size != key->Size
+        || result->Time.dwLowDateTime != key->Time.dwLowDateTime
+        || result->Time.dwHighDateTime != key->Time.dwHighDateTime
+        || result->Offset != key->Offset
+        || size != sizeof(ARCHIVEDETAILSHEADER)
+            + (unsigned long long)result->Count * (sizeof(ARCHIVEITEMDESCRIPTOR64) + sizeof(unsigned))
+            + (unsigned long long)result->OffsetCount * sizeof(unsigned long long) + result->NameSize)
+    {
+        file.Unmap(result);
+
+        return NULL;
+    }
+
+    return result;
+}
+
+void SaveArchiveDetails(const char* path, ARCHIVEDETAILSHEADERPTR header,
+    ARCHIVEITEMDESCRIPTOR64PTR items, unsigned long long* offsets, unsigned* hashes, char* names)
+{
+    char name[MAX_PATH];
+    char temp[MAX_PATH];
+
+    if (MAX_PATH <= strlen(path) + strlen(ARCHIVE_DETAILS_EXTENSION) + 12) { return; }
+
+    sprintf(name, "%s%s", path, ARCHIVE_DETAILS_EXTENSION);
+    sprintf(temp, "%s.%u", name, (unsigned)GetCurrentProcessId());
+
+    File file;
+
+    if (!file.Open(temp, (FILEOPENOPTIONS)(FILEOPENOPTIONS_CREATE | FILEOPENOPTIONS_WRITE))) { return; }
+
+    file.Write(header, sizeof(ARCHIVEDETAILSHEADER));
+    file.Write(items, header->Count * sizeof(ARCHIVEITEMDESCRIPTOR64));
+    file.Write(offsets, header->OffsetCount * sizeof(unsigned long long));
+    file.Write(hashes, header->Count * sizeof(unsigned));
+    file.Write(names, header->NameSize);
+
+    file.Close();
+
+    // NOTE: Replaced in one go, so that the concurrent opens never see a partially written file.
+    if (!MoveFileExA(temp, name, MOVEFILE_REPLACE_EXISTING)) { DeleteFileA(temp); }
+}
+
 // 0x00401670
-void AcquireArchiveItem(ARCHIVEITEMDESCRIPTORPTR item, const unsigned archive, const char* names)
+void AcquireArchiveItem(ARCHIVEITEMDESCRIPTOR64PTR item, const unsigned archive, const char* names, const unsigned hash)
 {
     const char* name = (const char*)((size_t)names + (size_t)item->Name);
 
-    unsigned indx = crc32_z(0, (byte*)name, strlen(name) + 1) & ARCHIVE_ITEM_INDEX_MASK;
+    {
+        const int indx = AcquireArchiveItemIndex(name, hash);
+
+        if (indx != INVALID_ARCHIVE_ITEM_INDEX)
+        {
+            // NOTE:
+            // Within the same priority the first item with a given name wins, same as the lookup always did,
+            // otherwise the item of the higher priority archive takes over the existing slot, so that the name
+            // still resolves with a single lookup no matter how many archives are mounted.
+            if (State.Archives[archive].Priority <= State.Archives[State.Items[indx].Archive].Priority) { return; }
+
+            InitializeArchiveItem(indx, item, archive, name);
+
+            return;
+        }
+    }
 
-    for (int i = 0; i < MAX_ARCHIVE_ITEM_COUNT; i++)
+    if (State.ItemCount == State.ItemCapacity)
     {
-        if (State.Items[indx].Type != ARCHIVEITEMTYPE_NONE) { indx = (indx + 1) % MAX_ARCHIVE_ITEM_COUNT; }
+        State.ItemCapacity = max(MIN_ARCHIVE_ITEM_COUNT, State.ItemCapacity * 2);
+        State.Items = (ARCHIVEITEMPTR)realloc(State.Items, State.ItemCapacity * sizeof(ARCHIVEITEM));
     }
 
+    // Keep the index at most half full.
+    if (State.Index.Capacity < (State.Index.Count + 1) * 2) { InitializeArchiveItemIndex(State.Index.Capacity * 2); }
+
+    const unsigned indx = State.ItemCount;
+
+    State.Items[indx].Hash = hash;
+
+    InitializeArchiveItem(indx, item, archive, name);
+
+    State.ItemCount = State.ItemCount + 1;
+
+    unsigned slot = State.Items[indx].Hash & (State.Index.Capacity - 1);
+
+    while (State.Index.Items[slot] != INVALID_ARCHIVE_ITEM_INDEX) { slot = (slot + 1) & (State.Index.Capacity - 1); }
+
+    State.Index.Items[slot] = indx;
+    State.Index.Count = State.Index.Count + 1;
+}
+
+void InitializeArchiveItem(const int indx, ARCHIVEITEMDESCRIPTOR64PTR item, const unsigned archive, const char* name)
+{
     State.Items[indx].Name = name;
     State.Items[indx].Type = item->Type;
     State.Items[indx].Archive = archive;
 
-    // NOTE: Don't ask me why...
-    State.Items[indx].File.Handle = (HANDLE)item->Offset;
+    State.Items[indx].File = File();
+    State.Items[indx].Position = item->Offset;
     State.Items[indx].Size = item->Size;
     State.Items[indx].Chunk = item->Chunk;
     State.Items[indx].Offset = 0;
+    State.Items[indx].IsActive = false;
+}
+
+unsigned AcquireArchiveItemHash(const char* name)
+{
+    // NOTE: The names are compared case-insensitively, so is the hash.
+    byte value[MAX_ARCHIVE_PATH_LENGTH];
+
+    unsigned result = 0;
+    size_t length = 0;
+
+    for (const char* x = name; ; x++)
+    {
+        value[length] = (byte)tolower((unsigned char)*x);
+        length = length + 1;
+
+        if (*x == NULL || length == MAX_ARCHIVE_PATH_LENGTH)
+        {
+            result = crc32_z(result, value, length);
+            length = 0;
+        }
+
+        if (*x == NULL) { break; }
+    }
+
+    return result;
+}
+
+void InitializeArchiveItemIndex(const unsigned count)
+{
+    free(State.Index.Items);
+
+    State.Index.Count = 0;
+    State.Index.Capacity = max(MIN_ARCHIVE_ITEM_INDEX_COUNT, count);
+    State.Index.Items = (int*)malloc(State.Index.Capacity * sizeof(int));
+
+    for (unsigned i = 0; i < State.Index.Capacity; i++) { State.Index.Items[i] = INVALID_ARCHIVE_ITEM_INDEX; }
+
+    // Re-insert the existing items with their stored hashes.
+    for (unsigned i = 0; i < State.ItemCount; i++)
+    {
+        unsigned slot = State.Items[i].Hash & (State.Index.Capacity - 1);
+
+        while (State.Index.Items[slot] != INVALID_ARCHIVE_ITEM_INDEX) { slot = (slot + 1) & (State.Index.Capacity - 1); }
+
+        State.Index.Items[slot] = i;
+        State.Index.Count = State.Index.Count + 1;
+    }
 }
 
 // 0x00401810
 int AcquireArchiveItemIndex(const char* name)
 {
-    int indx = crc32_z(0, (byte*)name, strlen(name) + 1) & ARCHIVE_ITEM_INDEX_MASK;
+    const long long start = AcquireStatisticsTime();
+
+    const int result = AcquireArchiveItemIndex(name, AcquireArchiveItemHash(name));
+
+    ReleaseStatisticsTime(STATISTICSPHASE_LOOKUP, start, 0);
 
-    for (int i = indx; i < MAX_ARCHIVE_ITEM_COUNT; i++)
+    return result;
+}
+
+int AcquireArchiveItemIndex(const char* name, const unsigned hash)
+{
+    for (unsigned slot = hash & (State.Index.Capacity - 1); ; slot = (slot + 1) & (State.Index.Capacity - 1))
     {
-        if (State.Items[indx].Type == ARCHIVEITEMTYPE_NONE || _strcmpi(State.Items[indx].Name, name) == 0) { return indx; }
+        const int indx = State.Index.Items[slot];
 
-        indx = (indx + 1) % MAX_ARCHIVE_ITEM_COUNT;
+        if (indx == INVALID_ARCHIVE_ITEM_INDEX) { return INVALID_ARCHIVE_ITEM_INDEX; }
+
+        if (State.Items[indx].Hash == hash && _strcmpi(State.Items[indx].Name, name) == 0) { return indx; }
     }
 
     return INVALID_ARCHIVE_ITEM_INDEX;
 }
 
+void AcquireArchiveItemFilePath(const int indx, char* path)
+{
+    sprintf(path, "%s%s", State.Archives[State.Items[indx].Archive].Path, State.Items[indx].Name);
+}
+
 // 0x00401750
 bool OpenArchiveItem(const int indx)
 {
@@ -141,14 +595,14 @@ bool OpenArchiveItem(const int indx)
     {
     case ARCHIVEITEMTYPE_FILE:
     {
-        char path[MAX_ARCHIVE_PATH_LENGTH];
-
-        sprintf(path, "%s%s", State.Archives[State.Items[indx].Archive].Path, State.Items[indx].Name);
+        char path[MAX_PATH];
+        AcquireArchiveItemFilePath(indx, path);
 
         return State.Items[indx].File.Open(path, FILEOPENOPTIONS_READ);
     }
     case ARCHIVEITEMTYPE_PACKED:
     case ARCHIVEITEMTYPE_COMPRESSED:
+    case ARCHIVEITEMTYPE_LZ4:
     {
         if (State.Items[indx].IsActive) { return false; }
 
@@ -163,13 +617,14 @@ bool OpenArchiveItem(const int indx)
 }
 
 // 0x00401d00
-unsigned ArchiveItemSize(const int indx)
+unsigned long long ArchiveItemSize(const int indx)
 {
     switch (State.Items[indx].Type)
     {
     case ARCHIVEITEMTYPE_FILE: { return State.Items[indx].File.Size(); }
     case ARCHIVEITEMTYPE_PACKED:
-    case ARCHIVEITEMTYPE_COMPRESSED: { return State.Items[indx].Size; }
+    case ARCHIVEITEMTYPE_COMPRESSED:
+    case ARCHIVEITEMTYPE_LZ4: { return State.Items[indx].Size; }
     }
 
     return 0;
@@ -184,12 +639,18 @@ bool IsArchiveItemAvailable(const int indx)
     {
     case ARCHIVEITEMTYPE_FILE: { return State.Items[indx].File.Handle != INVALID_HANDLE_VALUE; }
     case ARCHIVEITEMTYPE_PACKED:
-    case ARCHIVEITEMTYPE_COMPRESSED: { return State.Items[indx].IsActive; }
+    case ARCHIVEITEMTYPE_COMPRESSED:
+    case ARCHIVEITEMTYPE_LZ4: { return State.Items[indx].IsActive; }
     }
 
     return false;
 }
 
+bool IsCompressedArchiveItem(const int indx)
+{
+    return State.Items[indx].Type == ARCHIVEITEMTYPE_COMPRESSED || State.Items[indx].Type == ARCHIVEITEMTYPE_LZ4;
+}
+
 // 0x00401980
 unsigned ReadArchiveItem(const int indx, void* content, unsigned size)
 {
@@ -199,7 +660,13 @@ unsigned ReadArchiveItem(const int indx, void* content, unsigned size)
     {
         if (State.Items[indx].File.Handle == INVALID_HANDLE_VALUE) { return 0; }
 
-        return State.Items[indx].File.Read(content, size);
+        const long long start = AcquireStatisticsTime();
+
+        const unsigned result = State.Items[indx].File.Read(content, size);
+
+        ReleaseStatisticsTime(STATISTICSPHASE_READ, start, result);
+
+        return result;
     }
     case ARCHIVEITEMTYPE_PACKED:
     {
@@ -210,6 +677,7 @@ unsigned ReadArchiveItem(const int indx, void* content, unsigned size)
         return result;
     }
     case ARCHIVEITEMTYPE_COMPRESSED:
+    case ARCHIVEITEMTYPE_LZ4:
     {
         unsigned result = ReadCompressedArchiveItem(content, indx, State.Items[indx].Offset, size);
 
@@ -231,67 +699,104 @@ void CloseArchiveItem(const int indx)
     {
         State.Items[indx].File.Close();
     }
-    else if (type == ARCHIVEITEMTYPE_PACKED || type == ARCHIVEITEMTYPE_COMPRESSED)
+    else if (type == ARCHIVEITEMTYPE_PACKED || type == ARCHIVEITEMTYPE_COMPRESSED || type == ARCHIVEITEMTYPE_LZ4)
     {
         State.Items[indx].IsActive = false;
     }
 }
 
-// 0x00401c60
-unsigned ReadPackedArchiveItem(void* content, const int indx, const unsigned offset, const unsigned size)
+unsigned ReadArchiveContent(const unsigned archive, void* content, const unsigned size, const unsigned long long offset)
 {
-    const unsigned archive = State.Items[indx].Archive;
+    ARCHIVEWINDOWPTR window = &State.Archives[archive].Window;
 
-    if (State.Archives[archive].File.Handle == INVALID_HANDLE_VALUE)
+    if (window->Content == NULL || MAX_ARCHIVE_WINDOW_READ_SIZE < size)
     {
-        State.Archives[archive].File.Open(State.Archives[archive].Path, FILEOPENOPTIONS_READ);
+        return State.Archives[archive].File.ReadAt(content, size, offset);
     }
 
+    EnterCriticalSection(&window->Lock);
+
+    // The window moves forward to the read that falls outside of it.
+    if (offset < window->Offset || window->Offset + window->Length < offset + size)
+    {
+        window->Offset = offset;
+        window->Length = State.Archives[archive].File.ReadAt(window->Content, ARCHIVE_WINDOW_SIZE, offset);
+    }
+
+    const unsigned long long end = window->Offset + window->Length;
+    const unsigned result = end < offset + size ? (unsigned)(end - offset) : size;
+
+    memcpy(content, window->Content + (size_t)(offset - window->Offset), result);
+
+    LeaveCriticalSection(&window->Lock);
+
+    return result;
+}
+
+// 0x00401c60
+unsigned ReadPackedArchiveItem(void* content, const int indx, const unsigned long long offset, const unsigned size)
+{
+    if (State.Items[indx].Size <= offset) { return 0; }
+
+    const unsigned archive = State.Items[indx].Archive;
+
     unsigned result = State.Items[indx].Size < offset + size
-        ? State.Items[indx].Size - offset : size;
+        ? (unsigned)(State.Items[indx].Size - offset) : size;
 
     if (result != 0)
     {
-        // NOTE: Don't ask me why...
-        const unsigned start = (unsigned)State.Items[indx].File.Handle;
+        const unsigned long long start = State.Items[indx].Position;
+
+        if (State.Archives[archive].Content != NULL)
+        {
+            memcpy(content, (void*)((byte*)State.Archives[archive].Content + (size_t)(start + offset)), result);
+
+            return result;
+        }
+
+        const long long time = AcquireStatisticsTime();
+
+        result = ReadArchiveContent(archive, content, result, start + offset);
 
-        State.Archives[archive].File.SetPosition(start + offset, FILE_BEGIN);
-        State.Archives[archive].File.Read(content, result);
+        ReleaseStatisticsTime(STATISTICSPHASE_READ, time, result);
     }
 
     return result;
 }
 
+const void* AcquireArchiveItemView(const int indx)
+{
+    if (indx == INVALID_ARCHIVE_ITEM_INDEX) { return NULL; }
+    if (State.Items[indx].Type != ARCHIVEITEMTYPE_PACKED) { return NULL; }
+
+    const unsigned archive = State.Items[indx].Archive;
+
+    if (State.Archives[archive].Content == NULL) { return NULL; }
+
+    return (void*)((byte*)State.Archives[archive].Content + (size_t)State.Items[indx].Position);
+}
+
 // 0x00401a20
-unsigned ReadCompressedArchiveItem(void* content, const int indx, const unsigned offset, const unsigned size)
+unsigned ReadCompressedArchiveItem(void* content, const int indx, const unsigned long long offset, const unsigned size)
 {
     if (State.Items[indx].Size <= offset) { return 0; }
 
-    unsigned chunk = offset / State.Items[indx].Chunk;
+    unsigned chunk = (unsigned)(offset / State.Items[indx].Chunk);
 
     // Offset within current chunk, 0 for non-initial chunk
-    unsigned start = offset - chunk * State.Items[indx].Chunk;
+    unsigned start = (unsigned)(offset - (unsigned long long)chunk * State.Items[indx].Chunk);
 
     unsigned completed = 0;
     unsigned left = size;
 
-    unsigned actual = size;
-    if (State.Items[indx].Size < offset + actual)
-    {
-        left = State.Items[indx].Size - offset;
-        actual = left;
-    }
+    if (State.Items[indx].Size < offset + left) { left = (unsigned)(State.Items[indx].Size - offset); }
 
     while (left != 0)
     {
-        const unsigned length = left < State.Items[indx].Size - start
-            ? left : State.Items[indx].Size - start;
-
-        void* value = ReadArchiveItemChunk(indx, chunk);
-
-        if (value == NULL) { break; }
+        const unsigned length = left < State.Items[indx].Chunk - start
+            ? left : State.Items[indx].Chunk - start;
 
-        memcpy((void*)((byte*)content + completed), (void*)((byte*)value + start), length);
+        if (!ReadArchiveItemChunk(indx, chunk, start, (void*)((byte*)content + completed), length)) { break; }
 
         completed = completed + length;
         left = left - length;
@@ -300,85 +805,443 @@ unsigned ReadCompressedArchiveItem(void* content, const int indx, const unsigned
         chunk = chunk + 1;
     }
 
-    return actual;
+    // NOTE: A chunk that fails to decompress ends the read short, so the readers can tell.
+    return completed;
+}
+
+unsigned ReadArchiveItemAt(const int indx, const unsigned long long offset, void* content, const unsigned size)
+{
+    if (indx == INVALID_ARCHIVE_ITEM_INDEX) { return 0; }
+
+    switch (State.Items[indx].Type)
+    {
+    case ARCHIVEITEMTYPE_FILE:
+    {
+        char path[MAX_PATH];
+        AcquireArchiveItemFilePath(indx, path);
+
+        File file;
+
+        if (!file.Open(path, FILEOPENOPTIONS_READ)) { return 0; }
+
+        const long long start = AcquireStatisticsTime();
+
+        const unsigned result = file.ReadAt(content, size, offset);
+
+        ReleaseStatisticsTime(STATISTICSPHASE_READ, start, result);
+
+        file.Close();
+
+        return result;
+    }
+    case ARCHIVEITEMTYPE_PACKED: { return ReadPackedArchiveItem(content, indx, offset, size); }
+    case ARCHIVEITEMTYPE_COMPRESSED:
+    case ARCHIVEITEMTYPE_LZ4: { return ReadCompressedArchiveItem(content, indx, offset, size); }
+    }
+
+    return 0;
 }
 
 // 0x00401bf0
 void* AcquireArchiveItemChunk(const int indx, const int chunk)
 {
-    for (unsigned x = 0; x < MAX_ARCHIVE_ITEM_CHUNK_COUNT; x++)
+    const unsigned archive = State.Items[indx].Archive;
+
+    ARCHIVEITEMCHUNKPTR value = State.Chunks.Buckets[AcquireArchiveItemChunkBucket(archive, indx, chunk)];
+
+    for (; value != NULL; value = value->Next)
+    {
+        if (value->Archive == archive && value->Index == indx && value->Chunk == chunk) { break; }
+    }
+
+    if (value == NULL)
+    {
+        State.Chunks.Misses = State.Chunks.Misses + 1;
+
+        return NULL;
+    }
+
+    State.Chunks.Hits = State.Chunks.Hits + 1;
+
+    // Move the chunk to the most recently used end of the list.
+    if (State.Chunks.Newest != value)
+    {
+        value->Newer->Older = value->Older;
+
+        if (value->Older != NULL) { value->Older->Newer = value->Newer; }
+        else { State.Chunks.Oldest = value->Newer; }
+
+        value->Newer = NULL;
+        value->Older = State.Chunks.Newest;
+
+        State.Chunks.Newest->Newer = value;
+        State.Chunks.Newest = value;
+    }
+
+    return value->Content;
+}
+
+bool IsArchiveItemChunkAvailable(const int indx, const int chunk)
+{
+    const unsigned archive = State.Items[indx].Archive;
+
+    for (ARCHIVEITEMCHUNKPTR x = State.Chunks.Buckets[AcquireArchiveItemChunkBucket(archive, indx, chunk)]; x != NULL; x = x->Next)
+    {
+        if (x->Archive == archive && x->Index == indx && x->Chunk == chunk) { return true; }
+    }
+
+    return false;
+}
+
+unsigned AcquireArchiveItemChunkBucket(const unsigned archive, const int indx, const int chunk)
+{
+    const unsigned value = (unsigned)indx * 0x9E3779B1 ^ (unsigned)chunk * 0x85EBCA77 ^ archive * 0xC2B2AE3D;
+
+    return (value ^ (value >> 15)) & (State.Chunks.BucketCount - 1);
+}
+
+void ReleaseArchiveItemChunk(ARCHIVEITEMCHUNKPTR value)
+{
+    // Hash bucket
+    {
+        ARCHIVEITEMCHUNKPTR* next = &State.Chunks.Buckets[AcquireArchiveItemChunkBucket(value->Archive, value->Index, value->Chunk)];
+
+        while (*next != value) { next = &(*next)->Next; }
+
+        *next = value->Next;
+    }
+
+    // Recently used list
+    {
+        if (value->Newer != NULL) { value->Newer->Older = value->Older; }
+        else { State.Chunks.Newest = value->Older; }
+
+        if (value->Older != NULL) { value->Older->Newer = value->Newer; }
+        else { State.Chunks.Oldest = value->Newer; }
+    }
+
+    State.Chunks.Size = State.Chunks.Size - value->Capacity;
+    State.Chunks.Count = State.Chunks.Count - 1;
+
+    ReleaseArchiveItemChunkBuffer(value);
+}
+
+ARCHIVEITEMCHUNKPTR AcquireArchiveItemChunkBuffer(const unsigned size)
+{
+    ARCHIVEITEMCHUNKPTR value = State.Chunks.Free;
+
+    if (value != NULL && size <= value->Capacity)
+    {
+        State.Chunks.Free = value->Next;
+
+        return value;
+    }
+
+    const unsigned capacity = max(size, State.Chunks.BufferSize);
+
+    value = (ARCHIVEITEMCHUNKPTR)malloc(sizeof(ARCHIVEITEMCHUNK) + capacity);
+
+    value->Capacity = capacity;
+    value->Content = (void*)((size_t)value + sizeof(ARCHIVEITEMCHUNK));
+
+    return value;
+}
+
+void ReleaseArchiveItemChunkBuffer(ARCHIVEITEMCHUNKPTR value)
+{
+    value->Next = State.Chunks.Free;
+    State.Chunks.Free = value;
+}
+
+ARCHIVEITEMCHUNKINPUTPTR AcquireArchiveItemChunkInput(const unsigned size)
+{
+    EnterCriticalSection(&State.Chunks.Lock);
+
+    ARCHIVEITEMCHUNKINPUTPTR value = State.Chunks.Inputs;
+
+    if (value != NULL && size <= value->Size) { State.Chunks.Inputs = value->Next; }
+    else { value = NULL; }
+
+    const unsigned capacity = max(size, State.Chunks.InputSize);
+
+    LeaveCriticalSection(&State.Chunks.Lock);
+
+    if (value == NULL)
+    {
+        value = (ARCHIVEITEMCHUNKINPUTPTR)malloc(sizeof(ARCHIVEITEMCHUNKINPUT) + capacity);
+
+        value->Size = capacity;
+        value->Content = (void*)((size_t)value + sizeof(ARCHIVEITEMCHUNKINPUT));
+    }
+
+    return value;
+}
+
+void ReleaseArchiveItemChunkInput(ARCHIVEITEMCHUNKINPUTPTR value)
+{
+    EnterCriticalSection(&State.Chunks.Lock);
+
+    if (value->Size < State.Chunks.InputSize) { free(value); }
+    else
+    {
+        value->Next = State.Chunks.Inputs;
+        State.Chunks.Inputs = value;
+    }
+
+    LeaveCriticalSection(&State.Chunks.Lock);
+}
+
+ARCHIVEITEMINFLATEPTR AcquireArchiveItemInflate(void)
+{
+    EnterCriticalSection(&State.Chunks.Lock);
+
+    ARCHIVEITEMINFLATEPTR value = State.Chunks.Inflates;
+
+    if (value != NULL) { State.Chunks.Inflates = value->Next; }
+
+    LeaveCriticalSection(&State.Chunks.Lock);
+
+    if (value == NULL)
+    {
+        value = (ARCHIVEITEMINFLATEPTR)malloc(sizeof(ARCHIVEITEMINFLATE));
+        ZeroMemory(value, sizeof(ARCHIVEITEMINFLATE));
+
+        if (inflateInit(&value->Stream) != Z_OK)
+        {
+            free(value);
+
+            return NULL;
+        }
+    }
+
+    return value;
+}
+
+void ReleaseArchiveItemInflate(ARCHIVEITEMINFLATEPTR value)
+{
+    EnterCriticalSection(&State.Chunks.Lock);
+
+    value->Next = State.Chunks.Inflates;
+    State.Chunks.Inflates = value;
+
+    LeaveCriticalSection(&State.Chunks.Lock);
+}
+
+// NOTE:
+// Same as the uncompress, except that the inflate state is reused instead of being set up and torn down for every chunk.
+bool InflateArchiveItemContent(void* content, const unsigned length, const void* input, const unsigned size)
+{
+    ARCHIVEITEMINFLATEPTR value = AcquireArchiveItemInflate();
+
+    if (value == NULL) { return false; }
+
+    inflateReset(&value->Stream);
+
+    value->Stream.next_in = (Bytef*)input;
+    value->Stream.avail_in = size;
+    value->Stream.next_out = (Bytef*)content;
+    value->Stream.avail_out = length;
+
+    const bool result = inflate(&value->Stream, Z_FINISH) == Z_STREAM_END && value->Stream.total_out == length;
+
+    ReleaseArchiveItemInflate(value);
+
+    return result;
+}
+
+void InitializeArchiveItemChunkBuffers(ARCHIVEITEMDESCRIPTOR64PTR items, const unsigned count)
+{
+    unsigned size = State.Chunks.BufferSize;
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        if (items[i].Type != ARCHIVEITEMTYPE_COMPRESSED && items[i].Type != ARCHIVEITEMTYPE_LZ4) { continue; }
+
+        const unsigned length = (unsigned)min(items[i].Chunk, items[i].Size);
+
+        if (size < length) { size = length; }
+    }
+
+    EnterCriticalSection(&State.Chunks.Lock);
+
+    if (State.Chunks.BufferSize < size)
+    {
+        State.Chunks.BufferSize = size;
+
+        // The recycled chunks are too small from now on.
+        while (State.Chunks.Free != NULL)
+        {
+            ARCHIVEITEMCHUNKPTR next = State.Chunks.Free->Next;
+
+            free(State.Chunks.Free);
+
+            State.Chunks.Free = next;
+        }
+    }
+
+    if (State.Chunks.InputSize < compressBound(size))
     {
-        if (State.Chunks[x].Index == indx && State.Chunks[x].Chunk == chunk && State.Chunks[x].Content != NULL)
+        State.Chunks.InputSize = compressBound(size);
+
+        // So are the staging buffers.
+        while (State.Chunks.Inputs != NULL)
         {
-            return State.Chunks[x].Content;
+            ARCHIVEITEMCHUNKINPUTPTR next = State.Chunks.Inputs->Next;
+
+            free(State.Chunks.Inputs);
+
+            State.Chunks.Inputs = next;
         }
     }
 
-    return NULL;
+    LeaveCriticalSection(&State.Chunks.Lock);
 }
 
 // 0x00401c30
-unsigned AcquireArchiveItemChunkLength(const int indx, const int size)
+unsigned AcquireArchiveItemChunkLength(const int indx, const unsigned long long size)
 {
     unsigned result = State.Items[indx].Chunk;
 
-    if (State.Items[indx].Size < result + size) { result = State.Items[indx].Size - size; }
+    if (State.Items[indx].Size < result + size) { result = (unsigned)(State.Items[indx].Size - size); }
 
     return result;
 }
 
 // 0x00401400
-void* InitializeArchiveItemChunk(const int indx, const unsigned chunk, const unsigned size)
+void InitializeArchiveItemChunk(ARCHIVEITEMCHUNKPTR value, const int indx, const unsigned chunk, const unsigned size)
 {
-    if (State.Chunks[State.ChunkCount].Content != NULL) { free(State.Chunks[State.ChunkCount].Content); }
+    // Another reader could have cached the same chunk in the meantime.
+    if (IsArchiveItemChunkAvailable(indx, chunk))
+    {
+        ReleaseArchiveItemChunkBuffer(value);
+
+        return;
+    }
 
-    State.Chunks[State.ChunkCount].Index = indx;
-    State.Chunks[State.ChunkCount].Chunk = chunk;
-    State.Chunks[State.ChunkCount].Size = size;
+    const unsigned archive = State.Items[indx].Archive;
+    const unsigned bucket = AcquireArchiveItemChunkBucket(archive, indx, chunk);
 
-    State.Chunks[State.ChunkCount].Content = malloc(size);
+    // Evict the least recently used chunks until the new one fits the budget.
+    while (State.Chunks.Oldest != NULL && State.Chunks.Capacity < State.Chunks.Size + value->Capacity)
+    {
+        ReleaseArchiveItemChunk(State.Chunks.Oldest);
 
-    void* result = State.Chunks[State.ChunkCount].Content;
+        State.Chunks.Evictions = State.Chunks.Evictions + 1;
+    }
 
-    // Wrap around...
-    State.ChunkCount = (State.ChunkCount + 1) & (MAX_ARCHIVE_ITEM_CHUNK_COUNT - 1);
+    value->Archive = archive;
+    value->Index = indx;
+    value->Chunk = chunk;
+    value->Size = size;
 
-    return result;
+    value->Next = State.Chunks.Buckets[bucket];
+    State.Chunks.Buckets[bucket] = value;
+
+    value->Newer = NULL;
+    value->Older = State.Chunks.Newest;
+
+    if (State.Chunks.Newest != NULL) { State.Chunks.Newest->Newer = value; }
+    else { State.Chunks.Oldest = value; }
+
+    State.Chunks.Newest = value;
+
+    State.Chunks.Size = State.Chunks.Size + value->Capacity;
+    State.Chunks.Count = State.Chunks.Count + 1;
 }
 
 // 0x00401af0
-void* ReadArchiveItemChunk(const int indx, const int chunk)
+bool ReadArchiveItemChunk(const int indx, const int chunk, const unsigned start, void* content, const unsigned length)
 {
-    void* result = AcquireArchiveItemChunk(indx, chunk);
+    const unsigned size = AcquireArchiveItemChunkLength(indx, (unsigned long long)State.Items[indx].Chunk * chunk);
+
+    // NOTE:
+    // The cached content is copied out while the lock is held,
+    // so that the other readers cannot evict the chunk from under the copy.
+    EnterCriticalSection(&State.Chunks.Lock);
 
-    if (result == NULL)
     {
-        const unsigned archive = State.Items[indx].Archive;
+        const void* value = AcquireArchiveItemChunk(indx, chunk);
 
-        if (State.Archives[archive].File.Handle == INVALID_HANDLE_VALUE)
+        if (value != NULL)
         {
-            State.Archives[archive].File.Open(State.Archives[archive].Path, FILEOPENOPTIONS_READ);
+            memcpy(content, (void*)((byte*)value + start), length);
+
+            LeaveCriticalSection(&State.Chunks.Lock);
+
+            return true;
         }
+    }
+
+    // Chunks covered as a whole are decompressed straight into the destination.
+    if (start == 0 && length == size)
+    {
+        LeaveCriticalSection(&State.Chunks.Lock);
+
+        return DecompressArchiveItemChunk(indx, chunk, content, length);
+    }
+
+    ARCHIVEITEMCHUNKPTR value = AcquireArchiveItemChunkBuffer(size);
+
+    LeaveCriticalSection(&State.Chunks.Lock);
+
+    // The decompression happens outside of the lock, so that the readers of the other chunks are not held up.
+    const bool result = DecompressArchiveItemChunk(indx, chunk, value->Content, size);
+
+    if (result) { memcpy(content, (void*)((byte*)value->Content + start), length); }
 
-        // NOTE: Don't ask me why...
-        const unsigned index = (unsigned)State.Items[indx].File.Handle + chunk;
+    EnterCriticalSection(&State.Chunks.Lock);
 
-        State.Archives[archive].File.SetPosition(State.Archives[archive].Offsets[index], FILEOPENOPTIONS_READ);
-        
-        const unsigned size = State.Archives[archive].Offsets[index + 1] - State.Archives[archive].Offsets[index];
+    // Do not keep the incomplete chunk around.
+    if (result) { InitializeArchiveItemChunk(value, indx, chunk, size); }
+    else { ReleaseArchiveItemChunkBuffer(value); }
 
-        unsigned length = AcquireArchiveItemChunkLength(indx, State.Items[indx].Chunk * chunk);
-        
-        Bytef* content = (Bytef*)malloc(size);
+    LeaveCriticalSection(&State.Chunks.Lock);
 
-        result = InitializeArchiveItemChunk(indx, chunk, length);
+    return result;
+}
 
-        if (State.Archives[archive].File.Read(content, size) != size) { return NULL; }
+bool DecompressArchiveItemChunk(const int indx, const int chunk, void* content, const unsigned length)
+{
+    const unsigned archive = State.Items[indx].Archive;
 
-        uncompress((Bytef*)result, (uLongf*)&length, content, size);
+    const unsigned long long index = State.Items[indx].Position + chunk;
+
+    const unsigned size = (unsigned)(State.Archives[archive].Offsets[index + 1] - State.Archives[archive].Offsets[index]);
+
+    if (State.Archives[archive].Content != NULL)
+    {
+        // Decompress straight from the mapped archive, no staging buffer required.
+        const Bytef* src = (Bytef*)State.Archives[archive].Content + (size_t)State.Archives[archive].Offsets[index];
 
-        free(content);
+        return DecompressArchiveItemContent(State.Items[indx].Type, content, length, src, size);
     }
 
+    ARCHIVEITEMCHUNKINPUTPTR input = AcquireArchiveItemChunkInput(size);
+
+    const long long start = AcquireStatisticsTime();
+
+    const unsigned read = ReadArchiveContent(archive, input->Content, size, State.Archives[archive].Offsets[index]);
+
+    ReleaseStatisticsTime(STATISTICSPHASE_READ, start, read);
+
+    bool result = read == size;
+
+    if (result) { result = DecompressArchiveItemContent(State.Items[indx].Type, content, length, input->Content, size); }
+
+    ReleaseArchiveItemChunkInput(input);
+
+    return result;
+}
+
+bool DecompressArchiveItemContent(const ARCHIVEITEMTYPE type, void* content, const unsigned length, const void* input, const unsigned size)
+{
+    const long long start = AcquireStatisticsTime();
+
+    const bool result = type == ARCHIVEITEMTYPE_LZ4
+        ? LZ4_decompress_safe((const char*)input, (char*)content, size, length) == (int)length
+        : InflateArchiveItemContent(content, length, input, size);
+
+    ReleaseStatisticsTime(STATISTICSPHASE_DECOMPRESS, start, length);
+
     return result;
 }
\ No newline at end of file
@@ -24,7 +24,12 @@ SOFTWARE.
 
 #include "File.hxx"
 
+#include <zlib.h>
+
 #define ARCHIVE_MAGIC               0x53465A46 /* FZFS */
+#define ARCHIVE_MAGIC_64            0x34365A46 /* FZ64 */
+
+#define ARCHIVE_VERSION_64          1
 
 #define INVALID_ARCHIVE_ITEM_INDEX  (-1)
 
@@ -34,6 +39,13 @@ typedef struct ArchiveHeader
     unsigned                    Offset;
 } ARCHIVEHEADER, * ARCHIVEHEADERPTR;
 
+typedef struct ArchiveHeader64
+{
+    unsigned                    Magic;
+    unsigned                    Version;
+    unsigned long long          Offset;
+} ARCHIVEHEADER64, * ARCHIVEHEADER64PTR;
+
 typedef struct ArchiveDescriptor
 {
     unsigned                    Size;
@@ -47,9 +59,14 @@ typedef enum ArchiveItemType
     ARCHIVEITEMTYPE_FILE        = 1, // Straight unpacked file
     ARCHIVEITEMTYPE_PACKED      = 2, // Packaged into an archive without compression
     ARCHIVEITEMTYPE_COMPRESSED  = 8, // Packaged into an archive with zlib compression
+    ARCHIVEITEMTYPE_LZ4         = 16, // Packaged into an archive with LZ4 compression
     ARCHIVEITEMTYPE_FORCE_DWORD = 0x7FFFFFFF
 } ARCHIVEITEMTYPE, * ARCHIVEITEMTYPEPTR;
 
+#define ARCHIVE_DETAILS_MAGIC       0x58495A46 /* FZIX */
+#define ARCHIVE_DETAILS_VERSION     2
+#define ARCHIVE_DETAILS_EXTENSION   ".idx"
+
 typedef struct ArchiveItemDescriptor
 {
     unsigned                    Name;
@@ -59,63 +76,241 @@ typedef struct ArchiveItemDescriptor
     unsigned                    Chunk;
 } ARCHIVEITEMDESCRIPTOR, * ARCHIVEITEMDESCRIPTORPTR;
 
-#define MAX_ARCHIVE_COUNT               16
+// NOTE:
+// The item of a large archive, the offsets table of such an archive is made of 64-bit values as well.
+// The items of the regular archives are widened to it on open.
+typedef struct ArchiveItemDescriptor64
+{
+    unsigned                    Name;
+    ARCHIVEITEMTYPE             Type;
+    unsigned long long          Offset; // Offset to the content within a file.
+    unsigned long long          Size;
+    unsigned                    Chunk;
+    unsigned                    Reserved;
+} ARCHIVEITEMDESCRIPTOR64, * ARCHIVEITEMDESCRIPTOR64PTR;
+
+// NOTE:
+// The sidecar file keeps the decompressed tables of an archive, so that they are used in place once mapped.
+// The header is followed by the item descriptors, the offsets, the item name hashes, and the names.
+typedef struct ArchiveDetailsHeader
+{
+    unsigned                    Magic;
+    unsigned                    Version;
+
+    // The archive the details were taken from.
+    unsigned long long          Size;
+    FILETIME                    Time;
+    unsigned long long          Offset;
+
+    unsigned                    Count;
+    unsigned                    NameSize;
+    unsigned                    OffsetCount;
+    unsigned                    Reserved;
+} ARCHIVEDETAILSHEADER, * ARCHIVEDETAILSHEADERPTR;
+
+#define MIN_ARCHIVE_COUNT               16
 #define MAX_ARCHIVE_PATH_LENGTH         256
 
-#define MAX_ARCHIVE_ITEM_COUNT          4096
-#define ARCHIVE_ITEM_INDEX_MASK         0xFFF
+#define MIN_ARCHIVE_DIRECTORY_ITEM_COUNT    256
+#define MIN_ARCHIVE_DIRECTORY_NAME_SIZE     (16 * 1024)
 
-#define MAX_ARCHIVE_ITEM_CHUNK_COUNT    8
+#define MIN_ARCHIVE_ITEM_COUNT          1024
+#define MIN_ARCHIVE_ITEM_INDEX_COUNT    4096 /* Power of two. */
+
+#define DEFAULT_ARCHIVE_ITEM_CHUNK_CACHE_SIZE   (4 * 1024 * 1024)
+#define MIN_ARCHIVE_ITEM_CHUNK_BUCKET_COUNT     64
+#define MAX_ARCHIVE_ITEM_CHUNK_BUCKET_COUNT     65536
+#define ARCHIVE_ITEM_CHUNK_BUCKET_SIZE          4096 /* Expected minimum chunk size per bucket. */
 
 typedef struct ArchiveItemChunk
 {
-    int             Index;
-    int             Chunk;
-    int             Size;
-    void*           Content;
+    unsigned                    Archive;
+    int                         Index;
+    int                         Chunk;
+    int                         Size;
+    unsigned                    Capacity;
+    void*                       Content; // Follows the chunk in the same allocation.
+
+    struct ArchiveItemChunk*    Next;   // Next chunk in the same hash bucket, or in the free list.
+    struct ArchiveItemChunk*    Newer;  // Toward the most recently used chunk.
+    struct ArchiveItemChunk*    Older;  // Toward the least recently used chunk.
 } ARCHIVEITEMCHUNK, * ARCHIVEITEMCHUNKPTR;
 
+typedef struct ArchiveItemChunkInput
+{
+    unsigned                        Size;
+    void*                           Content; // Follows the input in the same allocation.
+    struct ArchiveItemChunkInput*   Next;
+} ARCHIVEITEMCHUNKINPUT, * ARCHIVEITEMCHUNKINPUTPTR;
+
+// NOTE: The inflate state is set up once, and only reset between the chunks.
+typedef struct ArchiveItemInflate
+{
+    z_stream                        Stream;
+    struct ArchiveItemInflate*      Next;
+} ARCHIVEITEMINFLATE, * ARCHIVEITEMINFLATEPTR;
+
+// NOTE:
+// The cache is shared by all readers, every access to it goes through the lock.
+typedef struct ArchiveItemChunkCache
+{
+    CRITICAL_SECTION            Lock;
+
+    unsigned                    Size;       // Bytes of decompressed content held.
+    unsigned                    Capacity;   // Byte budget, the least recently used chunks are evicted past it.
+    unsigned                    Count;
+
+    unsigned                    BucketCount;
+    ARCHIVEITEMCHUNKPTR*        Buckets;
+
+    ARCHIVEITEMCHUNKPTR         Newest;
+    ARCHIVEITEMCHUNKPTR         Oldest;
+
+    // NOTE:
+    // Evicted chunks keep their buffers and are recycled, the buffers are sized
+    // to the largest chunk of the opened archives, so that the steady state reads do not allocate.
+    unsigned                    BufferSize;
+    ARCHIVEITEMCHUNKPTR         Free;
+
+    // NOTE: Staging buffers for the compressed chunks read from a file, one per concurrent reader.
+    unsigned                    InputSize;
+    ARCHIVEITEMCHUNKINPUTPTR    Inputs;
+
+    // NOTE: Inflate states for the compressed chunks, one per concurrent reader.
+    ARCHIVEITEMINFLATEPTR       Inflates;
+
+    unsigned                    Hits;
+    unsigned                    Misses;
+    unsigned                    Evictions;
+} ARCHIVEITEMCHUNKCACHE, * ARCHIVEITEMCHUNKCACHEPTR;
+
 typedef struct ArchiveItem
 {
     const char*                 Name;
+    unsigned                    Hash;   // Hash of the lower case name.
     ARCHIVEITEMTYPE             Type;
     unsigned                    Archive;
 
-    // NOTE:
-    // This is used either as a file, or an offset to the file within an archive.
     File                        File;
 
-    unsigned                    Size;
+    // NOTE:
+    // An offset to the packed content within an archive, or the first chunk of the compressed content.
+    unsigned long long          Position;
+
+    unsigned long long          Size;
     unsigned                    Chunk;
 
     // NOTE:
     // An offset of the actual content when reading it from the archive.
-    unsigned                    Offset;
+    unsigned long long          Offset;
 
     unsigned                    IsActive;
 } ARCHIVEITEM, * ARCHIVEITEMPTR;
 
+// NOTE:
+// Open addressing table of the item indexes, kept at most half full,
+// so that the lookups stay short no matter how many items are loaded.
+typedef struct ArchiveItemIndex
+{
+    unsigned                    Count;
+    unsigned                    Capacity;
+    int*                        Items;
+} ARCHIVEITEMINDEX, * ARCHIVEITEMINDEXPTR;
+
+#define ARCHIVE_WINDOW_SIZE             (4 * 1024 * 1024)
+#define MAX_ARCHIVE_WINDOW_READ_SIZE    (256 * 1024) /* The larger reads go straight to the file. */
+
+// NOTE:
+// The staging buffer of the extraction sweep, the reads of the neighbouring chunks and items
+// that follow each other in the archive are served from a single large read.
+typedef struct ArchiveWindow
+{
+    CRITICAL_SECTION            Lock;
+    unsigned long long          Offset;
+    unsigned                    Length;
+    byte*                       Content;
+} ARCHIVEWINDOW, * ARCHIVEWINDOWPTR;
+
 typedef struct Archive
 {
     bool                        IsActive;
+    int                         Priority; // Items of the higher priority archives override the items of the same name.
     char                        Path[MAX_ARCHIVE_PATH_LENGTH];
-    unsigned*                   Offsets;
+    unsigned long long*         Offsets;
     char*                       Names;
     File                        File;
+
+    // NOTE:
+    // A read-only view of the whole archive, when memory mapping is enabled.
+    void*                       Content;
+
+    // NOTE:
+    // The mapped sidecar file, when the tables come from it, the offsets and the names point into it.
+    ARCHIVEDETAILSHEADERPTR     Details;
+
+    // NOTE: Only active during the extraction, the other readers go straight to the file.
+    ARCHIVEWINDOW               Window;
 } ARCHIVE, * ARCHIVEPTR;
 
-bool OpenArchive(const char* path);
+// NOTE:
+// Items of a loose directory, collected before they are added,
+// so that the names buffer does not move under the items.
+typedef struct ArchiveDirectory
+{
+    unsigned                    Count;
+    unsigned                    Capacity;
+    ARCHIVEITEMDESCRIPTOR64PTR  Items;
+
+    unsigned                    NameSize;
+    unsigned                    NameCapacity;
+    char*                       Names;
+} ARCHIVEDIRECTORY, * ARCHIVEDIRECTORYPTR;
+
+bool MountArchive(const char* path, const int priority);
+bool OpenArchive(const char* path, const int priority);
+bool OpenArchiveDirectory(const char* path, const int priority);
+void ReadArchiveDirectory(ARCHIVEDIRECTORYPTR directory, const char* path, const char* name);
+unsigned AcquireArchive(void);
 int AcquireArchiveItemIndex(const char* name);
-void AcquireArchiveItem(ARCHIVEITEMDESCRIPTORPTR item, const unsigned archive, const char* names);
-void* ReadArchiveDetails(File* file, unsigned* count);
+int AcquireArchiveItemIndex(const char* name, const unsigned hash);
+void AcquireArchiveItem(ARCHIVEITEMDESCRIPTOR64PTR item, const unsigned archive, const char* names, const unsigned hash);
+void InitializeArchiveItem(const int indx, ARCHIVEITEMDESCRIPTOR64PTR item, const unsigned archive, const char* name);
+unsigned AcquireArchiveItemHash(const char* name);
+void InitializeArchiveItemIndex(const unsigned count);
+void AcquireArchiveItemFilePath(const int indx, char* path);
+bool ReadArchiveHeader(File* file, ARCHIVEHEADER64PTR header);
+void* ReadArchiveDetails(File* file, unsigned* count, unsigned* size);
+ARCHIVEITEMDESCRIPTOR64PTR AcquireArchiveItemDescriptors(ARCHIVEITEMDESCRIPTORPTR items, const unsigned count);
+unsigned long long* AcquireArchiveOffsets(unsigned* offsets, const unsigned count);
+void AcquireArchiveDetailsKey(File* file, const unsigned long long offset, ARCHIVEDETAILSHEADERPTR key);
+ARCHIVEDETAILSHEADERPTR OpenArchiveDetails(const char* path, ARCHIVEDETAILSHEADERPTR key);
+void SaveArchiveDetails(const char* path, ARCHIVEDETAILSHEADERPTR header,
+    ARCHIVEITEMDESCRIPTOR64PTR items, unsigned long long* offsets, unsigned* hashes, char* names);
 bool OpenArchiveItem(const int indx);
-unsigned ArchiveItemSize(const int indx);
+unsigned long long ArchiveItemSize(const int indx);
 bool IsArchiveItemAvailable(const int indx);
+bool IsCompressedArchiveItem(const int indx);
 void CloseArchiveItem(const int indx);
-unsigned ReadPackedArchiveItem(void* content, const int indx, const unsigned offset, const unsigned size);
-unsigned ReadCompressedArchiveItem(void* content, const int indx, const unsigned offset, const unsigned size);
+const void* AcquireArchiveItemView(const int indx);
+unsigned ReadArchiveContent(const unsigned archive, void* content, const unsigned size, const unsigned long long offset);
+unsigned ReadPackedArchiveItem(void* content, const int indx, const unsigned long long offset, const unsigned size);
+unsigned ReadCompressedArchiveItem(void* content, const int indx, const unsigned long long offset, const unsigned size);
 unsigned ReadArchiveItem(const int indx, void* content, const unsigned size);
-void* InitializeArchiveItemChunk(const int indx, const unsigned chunk, const unsigned size);
-unsigned AcquireArchiveItemChunkLength(const int indx, const int size);
-void* ReadArchiveItemChunk(const int indx, const int chunk);
-void* AcquireArchiveItemChunk(const int indx, const int chunk);
\ No newline at end of file
+unsigned ReadArchiveItemAt(const int indx, const unsigned long long offset, void* content, const unsigned size);
+void InitializeArchiveItemChunk(ARCHIVEITEMCHUNKPTR value, const int indx, const unsigned chunk, const unsigned size);
+unsigned AcquireArchiveItemChunkLength(const int indx, const unsigned long long size);
+bool ReadArchiveItemChunk(const int indx, const int chunk, const unsigned start, void* content, const unsigned length);
+bool DecompressArchiveItemChunk(const int indx, const int chunk, void* content, const unsigned length);
+bool DecompressArchiveItemContent(const ARCHIVEITEMTYPE type, void* content, const unsigned length, const void* input, const unsigned size);
+void* AcquireArchiveItemChunk(const int indx, const int chunk);
+bool IsArchiveItemChunkAvailable(const int indx, const int chunk);
+unsigned AcquireArchiveItemChunkBucket(const unsigned archive, const int indx, const int chunk);
+void ReleaseArchiveItemChunk(ARCHIVEITEMCHUNKPTR value);
+ARCHIVEITEMCHUNKPTR AcquireArchiveItemChunkBuffer(const unsigned size);
+void ReleaseArchiveItemChunkBuffer(ARCHIVEITEMCHUNKPTR value);
+ARCHIVEITEMCHUNKINPUTPTR AcquireArchiveItemChunkInput(const unsigned size);
+void ReleaseArchiveItemChunkInput(ARCHIVEITEMCHUNKINPUTPTR value);
+ARCHIVEITEMINFLATEPTR AcquireArchiveItemInflate(void);
+void ReleaseArchiveItemInflate(ARCHIVEITEMINFLATEPTR value);
+bool InflateArchiveItemContent(void* content, const unsigned length, const void* input, const unsigned size);
+void InitializeArchiveItemChunkBuffers(ARCHIVEITEMDESCRIPTOR64PTR items, const unsigned count);
\ No newline at end of file
@@ -20,8 +20,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
-#include "Archive.hxx"
 #include "Content.hxx"
+#include "State.hxx"
 
 // 0x00401720
 bool CLASSCALL Content::Open(const char* name)
@@ -30,36 +30,105 @@ bool CLASSCALL Content::Open(const char* name)
 
     if (this->Index == INVALID_ARCHIVE_ITEM_INDEX) { return false; }
 
-    return OpenArchiveItem(this->Index);
+    this->Offset = 0;
+    this->Next = 0;
+    this->Ahead = 0;
+
+    switch (State.Items[this->Index].Type)
+    {
+    case ARCHIVEITEMTYPE_FILE:
+    {
+        char path[MAX_PATH];
+        AcquireArchiveItemFilePath(this->Index, path);
+
+        return this->File.Open(path, FILEOPENOPTIONS_READ);
+    }
+    case ARCHIVEITEMTYPE_PACKED:
+    case ARCHIVEITEMTYPE_COMPRESSED:
+    case ARCHIVEITEMTYPE_LZ4:
+    {
+        this->IsActive = true;
+
+        return true;
+    }
+    }
+
+    return false;
 }
 
 // 0x00401ce0
-unsigned CLASSCALL Content::Size()
+unsigned long long CLASSCALL Content::Size()
 {
     if (!this->IsAvailable()) { return 0; }
 
+    if (State.Items[this->Index].Type == ARCHIVEITEMTYPE_FILE) { return this->File.Size(); }
+
     return ArchiveItemSize(this->Index);
 }
 
 // 0x00401890
 bool CLASSCALL Content::IsAvailable()
 {
-    return IsArchiveItemAvailable(this->Index);
+    if (this->Index == INVALID_ARCHIVE_ITEM_INDEX) { return false; }
+
+    if (State.Items[this->Index].Type == ARCHIVEITEMTYPE_FILE) { return this->File.Handle != INVALID_HANDLE_VALUE; }
+
+    return this->IsActive;
 }
 
 // 0x00401950
 unsigned CLASSCALL Content::Read(void* content, unsigned size)
 {
-    if (!this->IsAvailable()) { return false; }
+    const unsigned result = this->ReadAt(this->Offset, content, size);
 
-    return ReadArchiveItem(this->Index, content, size);
+    this->Offset = this->Offset + result;
+
+    return result;
 }
 
-// 0x00401900
-void CLASSCALL Content::Close()
+unsigned CLASSCALL Content::ReadAt(const unsigned long long offset, void* content, unsigned size)
 {
-    if (this->IsAvailable())
+    if (!this->IsAvailable()) { return 0; }
+
+    if (State.Items[this->Index].Type == ARCHIVEITEMTYPE_FILE) { return this->File.ReadAt(content, size, offset); }
+
+    const unsigned result = ReadArchiveItemAt(this->Index, offset, content, size);
+
+    if (State.ReadAhead.IsActive && IsCompressedArchiveItem(this->Index))
     {
-        CloseArchiveItem(this->Index);
+        if (result != 0 && offset == this->Next)
+        {
+            // Request the chunks from the one the next read starts in, the cached ones are skipped.
+            const unsigned chunk = (unsigned)((offset + result) / State.Items[this->Index].Chunk);
+            const unsigned count = (unsigned)((State.Items[this->Index].Size + State.Items[this->Index].Chunk - 1) / State.Items[this->Index].Chunk);
+
+            const unsigned first = max(chunk, this->Ahead);
+            const unsigned last = min(chunk + State.ReadAhead.ChunkCount, count);
+
+            if (first < last)
+            {
+                // NOTE: The requests that did not fit the queue are made again by the next read.
+                this->Ahead = first + AcquireReadAhead(this->Index, first, last - first);
+            }
+        }
+
+        this->Next = offset + result;
     }
+
+    return result;
+}
+
+const void* CLASSCALL Content::View()
+{
+    if (!this->IsAvailable()) { return NULL; }
+
+    return AcquireArchiveItemView(this->Index);
+}
+
+// 0x00401900
+void CLASSCALL Content::Close()
+{
+    if (this->File.Handle != INVALID_HANDLE_VALUE) { this->File.Close(); }
+
+    this->IsActive = false;
 }
\ No newline at end of file
@@ -22,16 +22,27 @@ SOFTWARE.
 
 #pragma once
 
-#include "Base.hxx"
+#include "File.hxx"
 
+// NOTE:
+// Each content keeps its own position, and its own file for the loose items,
+// so that any number of contents can read the same item at once.
 class Content
 {
 public:
+    Content() { Index = (unsigned)-1; Offset = 0; Next = 0; Ahead = 0; IsActive = false; }
     bool CLASSCALL Open(const char* name);
-    unsigned CLASSCALL Size();
+    unsigned long long CLASSCALL Size();
     bool CLASSCALL IsAvailable();
     unsigned CLASSCALL Read(void* content, unsigned size);
+    unsigned CLASSCALL ReadAt(const unsigned long long offset, void* content, unsigned size);
+    const void* CLASSCALL View();
     void CLASSCALL Close();
 public:
     unsigned Index;
+    unsigned long long Offset;
+    unsigned long long Next;    // The end of the last read, the reads starting there are sequential.
+    unsigned Ahead;             // The chunk the read-ahead was requested up to.
+    bool IsActive;
+    File File;
 };
\ No newline at end of file
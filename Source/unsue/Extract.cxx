@@ -0,0 +1,513 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Content.hxx"
+#include "Extract.hxx"
+#include "State.hxx"
+
+#include <direct.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void InitializeExtractionDirectories(const unsigned count)
+{
+    const unsigned capacity = State.Directories.Capacity;
+    unsigned* hashes = State.Directories.Hashes;
+    char** items = State.Directories.Items;
+
+    State.Directories.Count = 0;
+    State.Directories.Capacity = max(MIN_EXTRACTION_DIRECTORY_COUNT, count);
+    State.Directories.Hashes = (unsigned*)malloc(State.Directories.Capacity * sizeof(unsigned));
+    State.Directories.Items = (char**)calloc(State.Directories.Capacity, sizeof(char*));
+
+    // Re-insert the existing directories with their stored hashes.
+    for (unsigned i = 0; i < capacity; i++)
+    {
+        if (items[i] == NULL) { continue; }
+
+        unsigned slot = hashes[i] & (State.Directories.Capacity - 1);
+
+        while (State.Directories.Items[slot] != NULL) { slot = (slot + 1) & (State.Directories.Capacity - 1); }
+
+        State.Directories.Hashes[slot] = hashes[i];
+        State.Directories.Items[slot] = items[i];
+        State.Directories.Count = State.Directories.Count + 1;
+    }
+
+    free(hashes);
+    free(items);
+}
+
+void ReleaseExtractionDirectories(void)
+{
+    for (unsigned i = 0; i < State.Directories.Capacity; i++) { free(State.Directories.Items[i]); }
+
+    free(State.Directories.Hashes);
+    free(State.Directories.Items);
+
+    State.Directories.Count = 0;
+    State.Directories.Capacity = 0;
+    State.Directories.Hashes = NULL;
+    State.Directories.Items = NULL;
+}
+
+bool IsExtractionDirectoryAvailable(const char* path, const unsigned hash)
+{
+    for (unsigned slot = hash & (State.Directories.Capacity - 1); ; slot = (slot + 1) & (State.Directories.Capacity - 1))
+    {
+        if (State.Directories.Items[slot] == NULL) { return false; }
+
+        if (State.Directories.Hashes[slot] == hash && _strcmpi(State.Directories.Items[slot], path) == 0) { return true; }
+    }
+
+    return false;
+}
+
+void AcquireExtractionDirectory(char* path)
+{
+    const unsigned hash = AcquireArchiveItemHash(path);
+
+    if (IsExtractionDirectoryAvailable(path, hash)) { return; }
+
+    // The parent directories go first.
+    {
+        char* end = strrchr(path, '\\');
+
+        if (end != NULL)
+        {
+            *end = NULL;
+            AcquireExtractionDirectory(path);
+            *end = '\\';
+        }
+    }
+
+    mkdir(path);
+
+    // Keep the set at most half full.
+    if (State.Directories.Capacity < (State.Directories.Count + 1) * 2)
+    {
+        InitializeExtractionDirectories(State.Directories.Capacity * 2);
+    }
+
+    unsigned slot = hash & (State.Directories.Capacity - 1);
+
+    while (State.Directories.Items[slot] != NULL) { slot = (slot + 1) & (State.Directories.Capacity - 1); }
+
+    State.Directories.Hashes[slot] = hash;
+    State.Directories.Items[slot] = _strdup(path);
+    State.Directories.Count = State.Directories.Count + 1;
+}
+
+// NOTE:
+// Makes the whole output tree ahead of the extraction, so that the file writes are not interleaved with it.
+void InitializeArchiveItemDirectories(const char* root, const int* order, const unsigned count)
+{
+    for (unsigned i = 0; i < count; i++)
+    {
+        char path[MAX_PATH];
+        AcquireArchiveItemPath(root, State.Items[order[i]].Name, path);
+    }
+}
+
+void AcquireArchiveItemPath(const char* root, const char* name, char* path)
+{
+    sprintf(path, "%s\\%s", root, name);
+
+    const size_t len = strlen(path);
+
+    for (size_t k = 0; k < len; k++)
+    {
+        if (path[k] == '/') { path[k] = '\\'; }
+    }
+
+    char* end = strrchr(path, '\\');
+
+    if (end != NULL)
+    {
+        *end = NULL;
+        AcquireExtractionDirectory(path);
+        *end = '\\';
+    }
+}
+
+bool ExtractArchiveItem(const char* root, const int indx)
+{
+    if (!State.IsSilent) { printf("%d %s ", State.Items[indx].Type, State.Items[indx].Name); }
+
+    Content content;
+    content.Open(State.Items[indx].Name);
+
+    unsigned long long size = content.Size();
+    if (!State.IsSilent) { printf("%llu\n", size); }
+
+    char path[MAX_PATH];
+    AcquireArchiveItemPath(root, State.Items[indx].Name, path);
+
+    File file;
+    if (!file.Open(path, (FILEOPENOPTIONS)(FILEOPENOPTIONS_CREATE | FILEOPENOPTIONS_WRITE | FILEOPENOPTIONS_SEQUENTIAL)))
+    {
+        fprintf(stderr, "Cannot write %s\n", path);
+
+        content.Close();
+
+        return false;
+    }
+
+    file.Allocate(size);
+
+    bool result = true;
+
+    const void* view = content.View();
+
+    if (view != NULL)
+    {
+        // Packed content is written straight from the mapped archive.
+        for (const byte* x = (const byte*)view; size != 0; )
+        {
+            const unsigned length = (unsigned)min(size, MAX_CONTENT_VIEW_SIZE);
+
+            const long long start = AcquireStatisticsTime();
+
+            const unsigned written = file.Write((void*)x, length);
+
+            ReleaseStatisticsTime(STATISTICSPHASE_WRITE, start, written);
+
+            if (written != length) { result = false; break; }
+
+            x = x + length;
+            size = size - length;
+        }
+    }
+    else if (size != 0)
+    {
+        // NOTE:
+        // The compressed content is written a whole chunk at a time, and decompressed straight
+        // into the buffer being written unless the read-ahead already has the chunks in the cache.
+        // The rest of the content is copied in the large blocks.
+        const bool compressed = IsCompressedArchiveItem(indx);
+        const unsigned length = (unsigned)min(size, compressed ? State.Items[indx].Chunk : MAX_CONTENT_COPY_SIZE);
+
+        void* data = malloc(length);
+
+        for (unsigned chunk = 0; size != 0; chunk++)
+        {
+            unsigned len = 0;
+
+            if (compressed && !State.ReadAhead.IsActive)
+            {
+                len = AcquireArchiveItemChunkLength(indx, (unsigned long long)State.Items[indx].Chunk * chunk);
+
+                if (!DecompressArchiveItemChunk(indx, chunk, data, len)) { len = 0; }
+            }
+            else { len = content.Read(data, length); }
+
+            if (len == 0) { break; }
+
+            const long long start = AcquireStatisticsTime();
+
+            const unsigned written = file.Write(data, len);
+
+            ReleaseStatisticsTime(STATISTICSPHASE_WRITE, start, written);
+
+            if (written != len) { result = false; break; }
+
+            size = size - len;
+        }
+
+        free(data);
+    }
+
+    file.Close();
+    content.Close();
+
+    // NOTE: The file was allocated to its full size up front, so an incomplete one is removed.
+    if (!result || size != 0)
+    {
+        fprintf(stderr, result ? "Cannot read %s\n" : "Cannot write %s\n", result ? State.Items[indx].Name : path);
+
+        DeleteFileA(path);
+
+        return false;
+    }
+
+    return true;
+}
+
+unsigned long long AcquireArchiveItemOrigin(const int indx)
+{
+    switch (State.Items[indx].Type)
+    {
+    case ARCHIVEITEMTYPE_PACKED: { return State.Items[indx].Position; }
+    case ARCHIVEITEMTYPE_COMPRESSED:
+    case ARCHIVEITEMTYPE_LZ4: { return State.Archives[State.Items[indx].Archive].Offsets[State.Items[indx].Position]; }
+    }
+
+    return 0;
+}
+
+int CompareArchiveItemOrder(const void* a, const void* b)
+{
+    const int x = *(const int*)a;
+    const int y = *(const int*)b;
+
+    if (State.Items[x].Archive != State.Items[y].Archive) { return State.Items[x].Archive < State.Items[y].Archive ? -1 : 1; }
+
+    // The loose files go after the archived ones, in the order they were found.
+    const bool xf = State.Items[x].Type == ARCHIVEITEMTYPE_FILE;
+    const bool yf = State.Items[y].Type == ARCHIVEITEMTYPE_FILE;
+
+    if (xf != yf) { return xf ? 1 : -1; }
+
+    if (!xf)
+    {
+        const unsigned long long xo = AcquireArchiveItemOrigin(x);
+        const unsigned long long yo = AcquireArchiveItemOrigin(y);
+
+        if (xo != yo) { return xo < yo ? -1 : 1; }
+    }
+
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// NOTE:
+// The items are extracted in the order of their content within each archive,
+// so that the archive is read in a single forward sweep instead of seeking back and forth.
+int* AcquireArchiveItemOrder(unsigned* count)
+{
+    int* result = (int*)malloc(State.ItemCount * sizeof(int) + 1);
+
+    *count = 0;
+
+    for (int i = 0; i < (int)State.ItemCount; i++)
+    {
+        if (State.Items[i].Type == ARCHIVEITEMTYPE_NONE) { continue; }
+
+        result[*count] = i;
+        *count = *count + 1;
+    }
+
+    qsort(result, *count, sizeof(int), CompareArchiveItemOrder);
+
+    return result;
+}
+
+// NOTE:
+// The calling thread is the writer, it walks the items in the same order as the serial extraction,
+// while the worker threads decompress the chunks of the compressed items ahead of it.
+// Each task owns slot (task % SlotCount), the task is only allowed to start once the writer
+// has consumed the task that used the same slot before, so that the memory use is bounded.
+bool ExtractArchiveItems(const char* root, const unsigned threads, const int* order, const unsigned count)
+{
+    EXTRACTIONPOOL pool;
+
+    pool.Next = 0;
+    pool.IsAborted = false;
+    pool.Count = 0;
+
+    unsigned length = 0;
+
+    for (unsigned k = 0; k < count; k++)
+    {
+        const int i = order[k];
+
+        if (!IsCompressedArchiveItem(i) || State.Items[i].Size == 0) { continue; }
+
+        pool.Count = pool.Count + (unsigned)((State.Items[i].Size + State.Items[i].Chunk - 1) / State.Items[i].Chunk);
+
+        const unsigned chunk = (unsigned)min(State.Items[i].Chunk, State.Items[i].Size);
+
+        if (length < chunk) { length = chunk; }
+    }
+
+    pool.Tasks = (EXTRACTIONTASKPTR)malloc(pool.Count * sizeof(EXTRACTIONTASK) + 1);
+
+    {
+        unsigned task = 0;
+
+        for (unsigned k = 0; k < count; k++)
+        {
+            const int i = order[k];
+
+            if (!IsCompressedArchiveItem(i) || State.Items[i].Size == 0) { continue; }
+
+            const unsigned chunks = (unsigned)((State.Items[i].Size + State.Items[i].Chunk - 1) / State.Items[i].Chunk);
+
+            for (unsigned x = 0; x < chunks; x++)
+            {
+                pool.Tasks[task].Index = i;
+                pool.Tasks[task].Chunk = x;
+
+                task = task + 1;
+            }
+        }
+    }
+
+    pool.SlotCount = threads * EXTRACTION_SLOT_MULTIPLIER;
+    pool.Slots = (EXTRACTIONSLOTPTR)malloc(pool.SlotCount * sizeof(EXTRACTIONSLOT));
+
+    for (unsigned i = 0; i < pool.SlotCount; i++)
+    {
+        pool.Slots[i].Event = CreateEventA(NULL, FALSE, FALSE, NULL);
+        pool.Slots[i].IsFailed = false;
+        pool.Slots[i].Length = 0;
+        pool.Slots[i].Content = malloc(length + 1);
+    }
+
+    pool.Pending = CreateSemaphoreA(NULL, min(pool.SlotCount, pool.Count), MAXLONG, NULL);
+
+    HANDLE workers[MAX_EXTRACTION_THREAD_COUNT];
+
+    for (unsigned i = 0; i < threads; i++)
+    {
+        workers[i] = CreateThread(NULL, 0, ExtractArchiveItemChunks, &pool, 0, NULL);
+    }
+
+    bool result = true;
+    unsigned task = 0;
+
+    for (unsigned k = 0; k < count && result; k++)
+    {
+        const int i = order[k];
+
+        if (!IsCompressedArchiveItem(i))
+        {
+            if (!ExtractArchiveItem(root, i)) { result = false; }
+
+            continue;
+        }
+
+        if (!State.IsSilent) { printf("%d %s %llu\n", State.Items[i].Type, State.Items[i].Name, State.Items[i].Size); }
+
+        char path[MAX_PATH];
+        AcquireArchiveItemPath(root, State.Items[i].Name, path);
+
+        File file;
+        if (!file.Open(path, (FILEOPENOPTIONS)(FILEOPENOPTIONS_CREATE | FILEOPENOPTIONS_WRITE | FILEOPENOPTIONS_SEQUENTIAL)))
+        {
+            fprintf(stderr, "Cannot write %s\n", path);
+
+            result = false;
+
+            break;
+        }
+
+        file.Allocate(State.Items[i].Size);
+
+        const unsigned chunks = State.Items[i].Size == 0
+            ? 0 : (unsigned)((State.Items[i].Size + State.Items[i].Chunk - 1) / State.Items[i].Chunk);
+
+        for (unsigned x = 0; x < chunks; x++)
+        {
+            EXTRACTIONSLOTPTR slot = &pool.Slots[task % pool.SlotCount];
+
+            WaitForSingleObject(slot->Event, INFINITE);
+
+            // NOTE: A chunk that fails to decompress stops the extraction, the partial file is removed.
+            if (slot->IsFailed)
+            {
+                fprintf(stderr, "Cannot decompress %s\n", State.Items[i].Name);
+
+                result = false;
+
+                break;
+            }
+
+            const long long start = AcquireStatisticsTime();
+
+            const unsigned written = file.Write(slot->Content, slot->Length);
+
+            ReleaseStatisticsTime(STATISTICSPHASE_WRITE, start, written);
+
+            if (written != slot->Length)
+            {
+                fprintf(stderr, "Cannot write %s\n", path);
+
+                result = false;
+
+                break;
+            }
+
+            // The slot is free now, let the task that reuses it start.
+            if (task + pool.SlotCount < pool.Count) { ReleaseSemaphore(pool.Pending, 1, NULL); }
+
+            task = task + 1;
+        }
+
+        file.Close();
+
+        if (!result) { DeleteFileA(path); }
+    }
+
+    pool.IsAborted = true;
+
+    ReleaseSemaphore(pool.Pending, threads, NULL);
+
+    for (unsigned i = 0; i < threads; i++)
+    {
+        WaitForSingleObject(workers[i], INFINITE);
+        CloseHandle(workers[i]);
+    }
+
+    CloseHandle(pool.Pending);
+
+    for (unsigned i = 0; i < pool.SlotCount; i++)
+    {
+        CloseHandle(pool.Slots[i].Event);
+        free(pool.Slots[i].Content);
+    }
+
+    free(pool.Slots);
+    free(pool.Tasks);
+
+    return result;
+}
+
+DWORD WINAPI ExtractArchiveItemChunks(LPVOID parameter)
+{
+    EXTRACTIONPOOLPTR pool = (EXTRACTIONPOOLPTR)parameter;
+
+    while (true)
+    {
+        WaitForSingleObject(pool->Pending, INFINITE);
+
+        if (pool->IsAborted) { break; }
+
+        const unsigned task = (unsigned)InterlockedIncrement(&pool->Next) - 1;
+
+        if (pool->Count <= task) { break; }
+
+        const int indx = pool->Tasks[task].Index;
+        const unsigned chunk = pool->Tasks[task].Chunk;
+
+        EXTRACTIONSLOTPTR slot = &pool->Slots[task % pool->SlotCount];
+
+        // NOTE: The chunks are read with the positioned reads, so the workers share the archive file.
+        const unsigned length = AcquireArchiveItemChunkLength(indx, (unsigned long long)State.Items[indx].Chunk * chunk);
+
+        slot->IsFailed = !DecompressArchiveItemChunk(indx, chunk, slot->Content, length);
+        slot->Length = slot->IsFailed ? 0 : length;
+
+        SetEvent(slot->Event);
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
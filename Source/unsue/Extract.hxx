@@ -0,0 +1,85 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Archive.hxx"
+
+#define MAX_CONTENT_CHUNK_SIZE          4096
+#define MAX_CONTENT_COPY_SIZE           (1024 * 1024)
+#define MAX_CONTENT_VIEW_SIZE           0x40000000ULL
+
+#define MAX_EXTRACTION_THREAD_COUNT     64
+#define EXTRACTION_SLOT_MULTIPLIER      4
+
+#define MIN_EXTRACTION_DIRECTORY_COUNT  256 /* Power of two. */
+
+typedef struct ExtractionTask
+{
+    int                         Index;
+    unsigned                    Chunk;
+} EXTRACTIONTASK, * EXTRACTIONTASKPTR;
+
+typedef struct ExtractionSlot
+{
+    HANDLE                      Event;  // Signaled once the chunk is decompressed.
+    unsigned                    IsFailed;
+    unsigned                    Length;
+    void*                       Content;
+} EXTRACTIONSLOT, * EXTRACTIONSLOTPTR;
+
+typedef struct ExtractionPool
+{
+    HANDLE                      Pending;    // Counts the tasks that are allowed to start.
+    volatile LONG               Next;
+    unsigned                    IsAborted;
+
+    unsigned                    Count;
+    EXTRACTIONTASKPTR           Tasks;
+
+    unsigned                    SlotCount;
+    EXTRACTIONSLOTPTR           Slots;
+} EXTRACTIONPOOL, * EXTRACTIONPOOLPTR;
+
+// NOTE:
+// Open addressing set of the output directories made so far, kept at most half full,
+// so that the directory of each file is only made once.
+typedef struct ExtractionDirectories
+{
+    unsigned                    Count;
+    unsigned                    Capacity;
+    unsigned*                   Hashes;
+    char**                      Items;
+} EXTRACTIONDIRECTORIES, * EXTRACTIONDIRECTORIESPTR;
+
+void InitializeExtractionDirectories(const unsigned count);
+void ReleaseExtractionDirectories(void);
+bool IsExtractionDirectoryAvailable(const char* path, const unsigned hash);
+void AcquireExtractionDirectory(char* path);
+void InitializeArchiveItemDirectories(const char* root, const int* order, const unsigned count);
+void AcquireArchiveItemPath(const char* root, const char* name, char* path);
+bool ExtractArchiveItem(const char* root, const int indx);
+unsigned long long AcquireArchiveItemOrigin(const int indx);
+int CompareArchiveItemOrder(const void* a, const void* b);
+int* AcquireArchiveItemOrder(unsigned* count);
+bool ExtractArchiveItems(const char* root, const unsigned threads, const int* order, const unsigned count);
+DWORD WINAPI ExtractArchiveItemChunks(LPVOID parameter);
\ No newline at end of file
@@ -34,8 +34,13 @@ bool CLASSCALL File::Open(const char* path, const FILEOPENOPTIONS options)
         mode = mode | FILE_SHARE_WRITE;
     }
 
+    unsigned flags = FILE_ATTRIBUTE_NORMAL;
+
+    if (options & FILEOPENOPTIONS_SEQUENTIAL) { flags = flags | FILE_FLAG_SEQUENTIAL_SCAN; }
+    if (options & FILEOPENOPTIONS_RANDOM) { flags = flags | FILE_FLAG_RANDOM_ACCESS; }
+
     this->Handle = CreateFileA(path, access, mode, NULL,
-        (options & FILEOPENOPTIONS_CREATE) ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        (options & FILEOPENOPTIONS_CREATE) ? CREATE_ALWAYS : OPEN_EXISTING, flags, NULL);
 
     return this->Handle != INVALID_HANDLE_VALUE;
 }
@@ -58,22 +63,91 @@ unsigned CLASSCALL File::Read(void* content, const unsigned size)
     return result;
 }
 
+unsigned CLASSCALL File::ReadAt(void* content, const unsigned size, const unsigned long long offset)
+{
+    // NOTE: The position is passed along with the read, so that the concurrent reads do not share one.
+    OVERLAPPED overlapped;
+    ZeroMemory(&overlapped, sizeof(OVERLAPPED));
+
+    overlapped.Offset = (DWORD)offset;
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+    DWORD result = 0;
+
+    if (!ReadFile(this->Handle, content, size, &result, &overlapped)) { return 0; }
+
+    return result;
+}
+
 // 0x00401e30
 unsigned CLASSCALL File::Write(void* content, const unsigned size)
 {
-    unsigned written = size;
-    WriteFile(this->Handle, content, size, (DWORD*)&written, NULL);
-    return size;
+    // NOTE: A failed or a short write, e.g. on a full disk, reports the bytes actually written.
+    DWORD written = 0;
+    WriteFile(this->Handle, content, size, &written, NULL);
+    return written;
+}
+
+bool CLASSCALL File::Allocate(const unsigned long long size)
+{
+    // NOTE: The file is extended to its final size up front, so that it is not grown by every write.
+    LARGE_INTEGER value;
+    value.QuadPart = size;
+
+    if (!SetFilePointerEx(this->Handle, value, NULL, FILE_BEGIN)) { return false; }
+
+    const bool result = SetEndOfFile(this->Handle) != FALSE;
+
+    value.QuadPart = 0;
+    SetFilePointerEx(this->Handle, value, NULL, FILE_BEGIN);
+
+    return result;
 }
 
 // 0x00401e60
-void CLASSCALL File::SetPosition(const int offset, const int mode)
+void CLASSCALL File::SetPosition(const long long offset, const int mode)
 {
-    SetFilePointer(this->Handle, offset, NULL, mode);
+    LARGE_INTEGER value;
+    value.QuadPart = offset;
+
+    SetFilePointerEx(this->Handle, value, NULL, mode);
 }
 
 // 0x00401e80
-unsigned CLASSCALL File::Size()
+unsigned long long CLASSCALL File::Size()
+{
+    LARGE_INTEGER value;
+
+    if (!GetFileSizeEx(this->Handle, &value)) { return 0; }
+
+    return value.QuadPart;
+}
+
+// NOTE: The last write time, in the 100-nanosecond intervals since January 1, 1601, or zero if not available.
+unsigned long long CLASSCALL File::Time()
+{
+    FILETIME value;
+
+    if (!GetFileTime(this->Handle, NULL, NULL, &value)) { return 0; }
+
+    return ((unsigned long long)value.dwHighDateTime << 32) | value.dwLowDateTime;
+}
+
+void* CLASSCALL File::Map(void)
+{
+    HANDLE mapping = CreateFileMappingA(this->Handle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (mapping == NULL) { return NULL; }
+
+    void* result = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    // NOTE: The view keeps the mapping object alive on its own.
+    CloseHandle(mapping);
+
+    return result;
+}
+
+void CLASSCALL File::Unmap(void* content)
 {
-    return GetFileSize(this->Handle, NULL);
+    if (content != NULL) { UnmapViewOfFile(content); }
 }
\ No newline at end of file
@@ -29,6 +29,8 @@ typedef enum FileOpenOptions
     FILEOPENOPTIONS_READ        = 0,
     FILEOPENOPTIONS_WRITE       = 1,
     FILEOPENOPTIONS_CREATE      = 2,
+    FILEOPENOPTIONS_SEQUENTIAL  = 4, // The file is read or written front to back
+    FILEOPENOPTIONS_RANDOM      = 8, // The file is read at the scattered offsets
     FILEOPENOPTIONS_FORCE_DWORD = 0x7FFFFFF
 } FILEOPENOPTIONS, * FILEOPENOPTIONSPTR;
 
@@ -39,9 +41,14 @@ public:
     bool CLASSCALL Open(const char* path, const FILEOPENOPTIONS options);
     void CLASSCALL Close(void);
     unsigned CLASSCALL Read(void* content, const unsigned size);
+    unsigned CLASSCALL ReadAt(void* content, const unsigned size, const unsigned long long offset);
     unsigned CLASSCALL Write(void* content, const unsigned size);
-    void CLASSCALL SetPosition(const int offset, const int mode);
-    unsigned CLASSCALL Size();
+    bool CLASSCALL Allocate(const unsigned long long size);
+    void CLASSCALL SetPosition(const long long offset, const int mode);
+    unsigned long long CLASSCALL Size();
+    unsigned long long CLASSCALL Time();
+    void* CLASSCALL Map(void);
+    void CLASSCALL Unmap(void* content);
 public:
     HANDLE Handle;
 };
\ No newline at end of file
@@ -20,45 +20,13 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
-#include "Content.hxx"
+#include "Extract.hxx"
 #include "State.hxx"
 
 #include <direct.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-#define MAX_CONTENT_CHUNK_SIZE  4096
-
-APPSTATE State;
-
-// 0x004013e0
-void InitializeArchiveItemChunks(void)
-{
-    State.ChunkCount = 0;
-
-    for (unsigned i = 0; i < MAX_ARCHIVE_ITEM_CHUNK_COUNT; i++) { State.Chunks[i].Content = NULL; }
-}
-
-// 0x00401470
-void ReleaseArchiveItemChunks(void)
-{
-    for (unsigned i = 0; i < MAX_ARCHIVE_ITEM_CHUNK_COUNT; i++)
-    {
-        if (State.Chunks[i].Content != NULL) { free(State.Chunks[i].Content); }
-    }
-
-    InitializeArchiveItemChunks();
-}
-
-// 0x00401d30
-void Initialize(void)
-{
-    for (unsigned i = 0; i < MAX_ARCHIVE_ITEM_COUNT; i++) { State.Items[i].Type = ARCHIVEITEMTYPE_NONE; }
-    for (unsigned i = 0; i < MAX_ARCHIVE_COUNT; i++) { State.Archives[i].IsActive = false; }
-
-    InitializeArchiveItemChunks();
-}
-
 // 0x00401000
 int main(int argc, char* argv[])
 {
@@ -71,6 +39,29 @@ int main(int argc, char* argv[])
 
             if (param[0] != '-') { break; }
             else if (param[1] == 'q') { State.IsSilent = true; }
+            else if (param[1] == 'm') { State.IsMapped = true; }
+            else if (param[1] == 'i') { State.IsIndexed = true; }
+            else if (param[1] == 'c') { State.Chunks.Capacity = strtoul(&param[2], NULL, 10); }
+            else if (param[1] == 'a') { /* Mounted after the archive, see below. */ }
+            else if (param[1] == 'v') { State.Statistics.Mode = AcquireStatisticsMode(&param[2]); }
+            else if (param[1] == 'r')
+            {
+                State.ReadAhead.ChunkCount = min(atoi(&param[2]), MAX_READ_AHEAD_CHUNK_COUNT);
+            }
+            else if (param[1] == 'j')
+            {
+                State.ThreadCount = atoi(&param[2]);
+
+                if (State.ThreadCount == 0)
+                {
+                    SYSTEM_INFO info;
+                    GetSystemInfo(&info);
+
+                    State.ThreadCount = info.dwNumberOfProcessors;
+                }
+
+                State.ThreadCount = min(State.ThreadCount, MAX_EXTRACTION_THREAD_COUNT);
+            }
             else { x = x - 1; }
 
             x = x + 1;
@@ -78,21 +69,41 @@ int main(int argc, char* argv[])
 
         if (argc - x < 1)
         {
-            printf("Syntax: %s [switches] file.sue [outdir]\n-q         Quiet (no shell output)\n", argv[0]);
+            printf("Syntax: %s [switches] file.sue [outdir]\n-q         Quiet (no shell output)\n-m         Memory-map the archive file\n-i         Keep the archive tables in a sidecar file.sue.idx\n-j<n>      Decompress with <n> threads, all processors if omitted\n-c<nnn>    Chunk cache size=<nnn> bytes, default=4194304\n-r<n>      Read <n> chunks of compressed files ahead on a background thread\n-a<name>   Mount <name> over the archive, later ones take priority\n-v<mode>   Report the time and the bytes of each phase, the mode is summary(default), trace or json, json implies -q\nName can stand for an archive or a directory.\nDirectory names should end with a backslash.\n", argv[0]);
 
             exit(EXIT_FAILURE);
         }
     }
 
+    InitializeStatistics(State.Statistics.Mode);
+
     Initialize();
 
-    if (!OpenArchive(argv[x]))
+    // The items are extracted in the order of their content, so the archives are read front to back.
+    State.IsSequential = true;
+
+    if (!MountArchive(argv[x], 0))
     {
         fprintf(stderr, "Could not open resource file: %s\n", argv[x]);
 
         exit(EXIT_FAILURE);
     }
 
+    // Overlays, in the order of priority.
+    for (int i = 1, priority = 1; i < x; i++)
+    {
+        if (argv[i][1] != 'a') { continue; }
+
+        if (!MountArchive(&argv[i][2], priority))
+        {
+            fprintf(stderr, "Could not open resource file: %s\n", &argv[i][2]);
+
+            exit(EXIT_FAILURE);
+        }
+
+        priority = priority + 1;
+    }
+
     char root[MAX_PATH];
 
     if (argc - x < 2)
@@ -126,59 +137,45 @@ int main(int argc, char* argv[])
 
     mkdir(root);
 
-    for (int i = 0; i < MAX_ARCHIVE_ITEM_COUNT; i++)
-    {
-        if (State.Items[i].Type == ARCHIVEITEMTYPE_NONE) { continue; }
+    unsigned count = 0;
+    int* order = AcquireArchiveItemOrder(&count);
 
-        if (!State.IsSilent) { printf("%d %s ", State.Items[i].Type, State.Items[i].Name); }
-        
-        Content content;
-        content.Open(State.Items[i].Name);
+    InitializeExtractionDirectories(MIN_EXTRACTION_DIRECTORY_COUNT);
+    InitializeArchiveItemDirectories(root, order, count);
 
-        unsigned size = content.Size();
-        if (!State.IsSilent) { printf("%d\n", size); }
-
-        char path[MAX_PATH];
-        sprintf(path, "%s\\%s", root, State.Items[i].Name);
-
-        const size_t len = strlen(path);
-
-        for (size_t k = 0; k < len; k++)
-        {
-            if (path[k] == '/') { path[k] = '\\'; }
-            if (path[k] == '\\')
-            {
-                path[k] = NULL;
-                mkdir(path);
-                path[k] = '\\';
-            }
-        }
+    // The items are read in the order of their content, so the neighbouring reads are coalesced.
+    InitializeArchiveWindows();
 
-        File file;
-        if (!file.Open(path, (FILEOPENOPTIONS)(FILEOPENOPTIONS_CREATE | FILEOPENOPTIONS_WRITE)))
+    if (State.ThreadCount > 1)
+    {
+        if (!ExtractArchiveItems(root, State.ThreadCount, order, count))
         {
-            fprintf(stderr, "Cannot write %s\n", path);
-
             ReleaseArchiveItemChunks();
 
             exit(EXIT_FAILURE);
         }
-
+    }
+    else
+    {
+        for (unsigned i = 0; i < count; i++)
         {
-            unsigned len = 0;
-            for (; size != 0; size = size - len)
+            if (!ExtractArchiveItem(root, order[i]))
             {
-                byte data[MAX_CONTENT_CHUNK_SIZE];
-                len = content.Read(data, MAX_CONTENT_CHUNK_SIZE);
-                file.Write(data, len);
+                ReleaseArchiveItemChunks();
+
+                exit(EXIT_FAILURE);
             }
         }
-
-        file.Close();
-        content.Close();
     }
 
+    free(order);
+
+    ReleaseExtractionDirectories();
+
+    if (State.Statistics.Mode != STATISTICSMODE_NONE) { PrintStatistics(); }
+
     ReleaseArchiveItemChunks();
+    ReleaseArchives();
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "State.hxx"
+
+void InitializeReadAhead(void)
+{
+    State.ReadAhead.Next = 0;
+    State.ReadAhead.Count = 0;
+
+    InitializeCriticalSection(&State.ReadAhead.Lock);
+
+    State.ReadAhead.Pending = CreateSemaphoreA(NULL, 0, MAXLONG, NULL);
+
+    State.ReadAhead.IsActive = true;
+    State.ReadAhead.Thread = CreateThread(NULL, 0, ReadAheadArchiveItemChunks, NULL, 0, NULL);
+}
+
+void ReleaseReadAhead(void)
+{
+    if (!State.ReadAhead.IsActive) { return; }
+
+    State.ReadAhead.IsActive = false;
+
+    ReleaseSemaphore(State.ReadAhead.Pending, 1, NULL);
+
+    WaitForSingleObject(State.ReadAhead.Thread, INFINITE);
+
+    CloseHandle(State.ReadAhead.Thread);
+    CloseHandle(State.ReadAhead.Pending);
+
+    DeleteCriticalSection(&State.ReadAhead.Lock);
+}
+
+unsigned AcquireReadAhead(const int indx, const unsigned chunk, const unsigned count)
+{
+    EnterCriticalSection(&State.ReadAhead.Lock);
+
+    unsigned added = 0;
+
+    for (unsigned i = 0; i < count && State.ReadAhead.Count < MAX_READ_AHEAD_TASK_COUNT; i++)
+    {
+        const unsigned task = (State.ReadAhead.Next + State.ReadAhead.Count) % MAX_READ_AHEAD_TASK_COUNT;
+
+        State.ReadAhead.Tasks[task].Index = indx;
+        State.ReadAhead.Tasks[task].Chunk = chunk + i;
+
+        State.ReadAhead.Count = State.ReadAhead.Count + 1;
+
+        added = added + 1;
+    }
+
+    LeaveCriticalSection(&State.ReadAhead.Lock);
+
+    if (added != 0) { ReleaseSemaphore(State.ReadAhead.Pending, added, NULL); }
+
+    return added;
+}
+
+DWORD WINAPI ReadAheadArchiveItemChunks(LPVOID parameter)
+{
+    while (true)
+    {
+        WaitForSingleObject(State.ReadAhead.Pending, INFINITE);
+
+        if (!State.ReadAhead.IsActive) { break; }
+
+        EnterCriticalSection(&State.ReadAhead.Lock);
+
+        const int indx = State.ReadAhead.Tasks[State.ReadAhead.Next].Index;
+        const unsigned chunk = State.ReadAhead.Tasks[State.ReadAhead.Next].Chunk;
+
+        State.ReadAhead.Next = (State.ReadAhead.Next + 1) % MAX_READ_AHEAD_TASK_COUNT;
+        State.ReadAhead.Count = State.ReadAhead.Count - 1;
+
+        LeaveCriticalSection(&State.ReadAhead.Lock);
+
+        const unsigned size = AcquireArchiveItemChunkLength(indx, (unsigned long long)State.Items[indx].Chunk * chunk);
+
+        EnterCriticalSection(&State.Chunks.Lock);
+
+        if (IsArchiveItemChunkAvailable(indx, chunk))
+        {
+            LeaveCriticalSection(&State.Chunks.Lock);
+
+            continue;
+        }
+
+        ARCHIVEITEMCHUNKPTR value = AcquireArchiveItemChunkBuffer(size);
+
+        LeaveCriticalSection(&State.Chunks.Lock);
+
+        const bool result = DecompressArchiveItemChunk(indx, chunk, value->Content, size);
+
+        EnterCriticalSection(&State.Chunks.Lock);
+
+        if (result) { InitializeArchiveItemChunk(value, indx, chunk, size); }
+        else { ReleaseArchiveItemChunkBuffer(value); }
+
+        LeaveCriticalSection(&State.Chunks.Lock);
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Archive.hxx"
+
+#define MAX_READ_AHEAD_CHUNK_COUNT  64
+#define MAX_READ_AHEAD_TASK_COUNT   256
+
+typedef struct ReadAheadTask
+{
+    int                         Index;
+    unsigned                    Chunk;
+} READAHEADTASK, * READAHEADTASKPTR;
+
+// NOTE:
+// The chunks requested by the sequential readers are decompressed into the chunk cache
+// on a background thread, the requests that do not fit the queue are left for the next read.
+typedef struct ReadAhead
+{
+    unsigned                    IsActive;
+    unsigned                    ChunkCount; // Chunks to decompress ahead of a sequential reader.
+
+    HANDLE                      Thread;
+    HANDLE                      Pending;    // Counts the queued tasks.
+    CRITICAL_SECTION            Lock;
+
+    unsigned                    Next;
+    unsigned                    Count;
+    READAHEADTASK               Tasks[MAX_READ_AHEAD_TASK_COUNT];
+} READAHEAD, * READAHEADPTR;
+
+void InitializeReadAhead(void);
+void ReleaseReadAhead(void);
+unsigned AcquireReadAhead(const int indx, const unsigned chunk, const unsigned count);
+DWORD WINAPI ReadAheadArchiveItemChunks(LPVOID parameter);
\ No newline at end of file
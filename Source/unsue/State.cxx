@@ -0,0 +1,202 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "State.hxx"
+
+#include <stdlib.h>
+
+APPSTATE State;
+
+// 0x004013e0
+void InitializeArchiveItemChunks(void)
+{
+    if (State.Chunks.Capacity == 0) { State.Chunks.Capacity = DEFAULT_ARCHIVE_ITEM_CHUNK_CACHE_SIZE; }
+
+    InitializeCriticalSection(&State.Chunks.Lock);
+
+    State.Chunks.Size = 0;
+    State.Chunks.Count = 0;
+
+    State.Chunks.BucketCount = MIN_ARCHIVE_ITEM_CHUNK_BUCKET_COUNT;
+
+    while (State.Chunks.BucketCount < MAX_ARCHIVE_ITEM_CHUNK_BUCKET_COUNT
+        && State.Chunks.BucketCount * ARCHIVE_ITEM_CHUNK_BUCKET_SIZE < State.Chunks.Capacity)
+    {
+        State.Chunks.BucketCount = State.Chunks.BucketCount * 2;
+    }
+
+    State.Chunks.Buckets = (ARCHIVEITEMCHUNKPTR*)calloc(State.Chunks.BucketCount, sizeof(ARCHIVEITEMCHUNKPTR));
+
+    State.Chunks.Newest = NULL;
+    State.Chunks.Oldest = NULL;
+
+    State.Chunks.BufferSize = 0;
+    State.Chunks.Free = NULL;
+
+    State.Chunks.InputSize = 0;
+    State.Chunks.Inputs = NULL;
+
+    State.Chunks.Inflates = NULL;
+
+    State.Chunks.Hits = 0;
+    State.Chunks.Misses = 0;
+    State.Chunks.Evictions = 0;
+}
+
+// 0x00401470
+void ReleaseArchiveItemChunks(void)
+{
+    // The read-ahead thread fills the cache, so it goes first.
+    ReleaseReadAhead();
+
+    while (State.Chunks.Oldest != NULL) { ReleaseArchiveItemChunk(State.Chunks.Oldest); }
+
+    while (State.Chunks.Free != NULL)
+    {
+        ARCHIVEITEMCHUNKPTR next = State.Chunks.Free->Next;
+
+        free(State.Chunks.Free);
+
+        State.Chunks.Free = next;
+    }
+
+    while (State.Chunks.Inputs != NULL)
+    {
+        ARCHIVEITEMCHUNKINPUTPTR next = State.Chunks.Inputs->Next;
+
+        free(State.Chunks.Inputs);
+
+        State.Chunks.Inputs = next;
+    }
+
+    while (State.Chunks.Inflates != NULL)
+    {
+        ARCHIVEITEMINFLATEPTR next = State.Chunks.Inflates->Next;
+
+        inflateEnd(&State.Chunks.Inflates->Stream);
+        free(State.Chunks.Inflates);
+
+        State.Chunks.Inflates = next;
+    }
+
+    free(State.Chunks.Buckets);
+
+    State.Chunks.InputSize = 0;
+
+    State.Chunks.Buckets = NULL;
+    State.Chunks.BucketCount = 0;
+
+    DeleteCriticalSection(&State.Chunks.Lock);
+}
+
+// NOTE:
+// The mapped archives and the loose directories are read without the window.
+void InitializeArchiveWindows(void)
+{
+    for (unsigned i = 0; i < State.ArchiveCount; i++)
+    {
+        if (!State.Archives[i].IsActive || State.Archives[i].Content != NULL) { continue; }
+        if (State.Archives[i].File.Handle == INVALID_HANDLE_VALUE) { continue; }
+
+        InitializeCriticalSection(&State.Archives[i].Window.Lock);
+
+        State.Archives[i].Window.Offset = 0;
+        State.Archives[i].Window.Length = 0;
+        State.Archives[i].Window.Content = (byte*)malloc(ARCHIVE_WINDOW_SIZE);
+    }
+}
+
+void ReleaseArchiveWindows(void)
+{
+    for (unsigned i = 0; i < State.ArchiveCount; i++)
+    {
+        if (State.Archives[i].Window.Content == NULL) { continue; }
+
+        free(State.Archives[i].Window.Content);
+
+        State.Archives[i].Window.Content = NULL;
+
+        DeleteCriticalSection(&State.Archives[i].Window.Lock);
+    }
+}
+
+void ReleaseArchives(void)
+{
+    ReleaseArchiveWindows();
+
+    for (unsigned i = 0; i < State.ArchiveCount; i++)
+    {
+        if (!State.Archives[i].IsActive) { continue; }
+
+        if (State.Archives[i].Content != NULL)
+        {
+            State.Archives[i].File.Unmap(State.Archives[i].Content);
+            State.Archives[i].Content = NULL;
+        }
+
+        if (State.Archives[i].File.Handle != INVALID_HANDLE_VALUE) { State.Archives[i].File.Close(); }
+    }
+
+    free(State.Items);
+    free(State.Index.Items);
+
+    State.Items = NULL;
+    State.Index.Items = NULL;
+
+    for (unsigned i = 0; i < State.ArchiveCount; i++)
+    {
+        if (State.Archives[i].Details != NULL)
+        {
+            State.Archives[i].File.Unmap(State.Archives[i].Details);
+
+            continue;
+        }
+
+        free(State.Archives[i].Offsets);
+        free(State.Archives[i].Names);
+    }
+
+    free(State.Archives);
+
+    State.Archives = NULL;
+    State.ArchiveCount = 0;
+    State.ArchiveCapacity = 0;
+}
+
+// 0x00401d30
+void Initialize(void)
+{
+    State.ItemCount = 0;
+    State.ItemCapacity = 0;
+    State.Items = NULL;
+
+    State.Index.Items = NULL;
+    InitializeArchiveItemIndex(MIN_ARCHIVE_ITEM_INDEX_COUNT);
+
+    State.ArchiveCount = 0;
+    State.ArchiveCapacity = 0;
+    State.Archives = NULL;
+
+    InitializeArchiveItemChunks();
+
+    if (State.ReadAhead.ChunkCount != 0) { InitializeReadAhead(); }
+}
\ No newline at end of file
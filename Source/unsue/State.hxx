@@ -22,18 +22,42 @@ SOFTWARE.
 
 #pragma once
 
-#include "Archive.hxx"
+#include "Extract.hxx"
+#include "ReadAhead.hxx"
+#include "Statistics.hxx"
 
 #define MAX_MESSAGE_LENGTH  576
 
 typedef struct AppState
 {
     unsigned            IsSilent;                                   // 0x0060f194
-    unsigned            ChunkCount;                                 // 0x0060f198
+    unsigned            IsMapped;
+    unsigned            IsIndexed;
+    unsigned            IsSequential;                               // The archives are read front to back, as by the ordered extraction.
+    unsigned            ThreadCount;
 
-    ARCHIVEITEMCHUNK    Chunks[MAX_ARCHIVE_ITEM_CHUNK_COUNT];       // 0x0060f1a0
-    ARCHIVE             Archives[MAX_ARCHIVE_COUNT];                // 0x0060f220
-    ARCHIVEITEM         Items[MAX_ARCHIVE_ITEM_COUNT];              // 0x00610320
+    ARCHIVEITEMCHUNKCACHE Chunks;
+    READAHEAD           ReadAhead;
+    STATISTICS          Statistics;
+
+    unsigned            ArchiveCount;
+    unsigned            ArchiveCapacity;
+    ARCHIVEPTR          Archives;                                   // 0x0060f220
+
+    unsigned            ItemCount;
+    unsigned            ItemCapacity;
+    ARCHIVEITEMPTR      Items;
+
+    ARCHIVEITEMINDEX    Index;
+
+    EXTRACTIONDIRECTORIES Directories;
 } APPSTATE, * APPSTATEPTR;
 
-extern APPSTATE State;
\ No newline at end of file
+extern APPSTATE State;
+
+void Initialize(void);
+void InitializeArchiveItemChunks(void);
+void ReleaseArchiveItemChunks(void);
+void InitializeArchiveWindows(void);
+void ReleaseArchiveWindows(void);
+void ReleaseArchives(void);
\ No newline at end of file
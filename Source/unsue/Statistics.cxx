@@ -0,0 +1,188 @@
+/*
+Copyright (c) 2024 Americus Maximus
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "State.hxx"
+
+#include <stdio.h>
+
+void InitializeStatistics(const STATISTICSMODE mode)
+{
+    State.Statistics.Mode = mode;
+
+    // The report is the only output in JSON mode, so that it can be parsed.
+    if (mode == STATISTICSMODE_JSON) { State.IsSilent = true; }
+
+    QueryPerformanceFrequency(&State.Statistics.Frequency);
+
+    ZeroMemory(State.Statistics.Phases, STATISTICSPHASE_COUNT * sizeof(STATISTICSCOUNTER));
+
+    State.Statistics.Start = AcquireStatisticsTime();
+}
+
+STATISTICSMODE AcquireStatisticsMode(const char* value)
+{
+    if (_strcmpi(value, "trace") == 0) { return STATISTICSMODE_TRACE; }
+    if (_strcmpi(value, "json") == 0) { return STATISTICSMODE_JSON; }
+
+    return STATISTICSMODE_SUMMARY;
+}
+
+const char* AcquireStatisticsPhaseName(const STATISTICSPHASE phase)
+{
+    switch (phase)
+    {
+    case STATISTICSPHASE_INDEX: { return "index"; }
+    case STATISTICSPHASE_LOOKUP: { return "lookup"; }
+    case STATISTICSPHASE_READ: { return "read"; }
+    case STATISTICSPHASE_DECOMPRESS: { return "decompress"; }
+    case STATISTICSPHASE_WRITE: { return "write"; }
+    }
+
+    return "unknown";
+}
+
+// NOTE: Zero while the statistics are off, so that the timed code only pays for a branch.
+long long AcquireStatisticsTime(void)
+{
+    if (State.Statistics.Mode == STATISTICSMODE_NONE) { return 0; }
+
+    LARGE_INTEGER value;
+    QueryPerformanceCounter(&value);
+
+    return value.QuadPart;
+}
+
+void ReleaseStatisticsTime(const STATISTICSPHASE phase, const long long start, const unsigned long long bytes)
+{
+    if (State.Statistics.Mode == STATISTICSMODE_NONE) { return; }
+
+    STATISTICSCOUNTERPTR counter = &State.Statistics.Phases[phase];
+
+    InterlockedExchangeAdd64(&counter->Count, 1);
+    InterlockedExchangeAdd64(&counter->Bytes, (LONGLONG)bytes);
+    InterlockedExchangeAdd64(&counter->Time, AcquireStatisticsTime() - start);
+}
+
+double AcquireStatisticsSeconds(const long long time)
+{
+    return (double)time / (double)State.Statistics.Frequency.QuadPart;
+}
+
+// NOTE: The size the item takes within the archive, the chunks of a compressed item are followed by the offset of its end.
+unsigned long long AcquireArchiveItemStoredSize(const int indx)
+{
+    if (!IsCompressedArchiveItem(indx)) { return State.Items[indx].Size; }
+
+    if (State.Items[indx].Chunk == 0) { return 0; }
+
+    const unsigned long long* offsets = State.Archives[State.Items[indx].Archive].Offsets;
+
+    const unsigned long long position = State.Items[indx].Position;
+    const unsigned long long count = (State.Items[indx].Size + State.Items[indx].Chunk - 1) / State.Items[indx].Chunk;
+
+    return offsets[position + count] - offsets[position];
+}
+
+void PrintStatisticsString(const char* value)
+{
+    printf("\"");
+
+    for (; *value != NULL; value++)
+    {
+        if (*value == '\\' || *value == '"') { printf("\\"); }
+
+        printf("%c", *value);
+    }
+
+    printf("\"");
+}
+
+void PrintStatistics(void)
+{
+    const double total = AcquireStatisticsSeconds(AcquireStatisticsTime() - State.Statistics.Start);
+
+    const unsigned long long read = State.Statistics.Phases[STATISTICSPHASE_READ].Bytes;
+    const unsigned long long written = State.Statistics.Phases[STATISTICSPHASE_WRITE].Bytes;
+
+    if (State.Statistics.Mode == STATISTICSMODE_JSON)
+    {
+        printf("{\n  \"seconds\": %.6f,\n  \"read\": %llu,\n  \"written\": %llu,\n", total, read, written);
+        printf("  \"cache\": { \"hits\": %u, \"misses\": %u, \"evictions\": %u },\n",
+            State.Chunks.Hits, State.Chunks.Misses, State.Chunks.Evictions);
+
+        printf("  \"phases\": [\n");
+
+        for (unsigned i = 0; i < STATISTICSPHASE_COUNT; i++)
+        {
+            STATISTICSCOUNTERPTR counter = &State.Statistics.Phases[i];
+
+            printf("    { \"name\": \"%s\", \"count\": %lld, \"bytes\": %lld, \"seconds\": %.6f }%s\n",
+                AcquireStatisticsPhaseName((STATISTICSPHASE)i), counter->Count, counter->Bytes,
+                AcquireStatisticsSeconds(counter->Time), i + 1 < STATISTICSPHASE_COUNT ? "," : "");
+        }
+
+        printf("  ],\n  \"items\": [\n");
+
+        for (unsigned i = 0; i < State.ItemCount; i++)
+        {
+            const unsigned long long size = State.Items[i].Size;
+            const unsigned long long stored = AcquireArchiveItemStoredSize(i);
+
+            printf("    { \"name\": ");
+            PrintStatisticsString(State.Items[i].Name);
+            printf(", \"type\": %d, \"size\": %llu, \"stored\": %llu, \"ratio\": %.4f }%s\n",
+                State.Items[i].Type, size, stored, size == 0 ? 1.0 : (double)stored / (double)size,
+                i + 1 < State.ItemCount ? "," : "");
+        }
+
+        printf("  ]\n}\n");
+
+        return;
+    }
+
+    printf("\nPhase            Count            Bytes      Seconds\n");
+
+    for (unsigned i = 0; i < STATISTICSPHASE_COUNT; i++)
+    {
+        STATISTICSCOUNTERPTR counter = &State.Statistics.Phases[i];
+
+        printf("%-10s %11lld %16lld %12.6f\n", AcquireStatisticsPhaseName((STATISTICSPHASE)i),
+            counter->Count, counter->Bytes, AcquireStatisticsSeconds(counter->Time));
+    }
+
+    printf("\nRead %llu bytes, wrote %llu bytes in %.6f seconds\n", read, written, total);
+    printf("Chunk cache: %u hits, %u misses, %u evictions\n",
+        State.Chunks.Hits, State.Chunks.Misses, State.Chunks.Evictions);
+
+    if (State.Statistics.Mode != STATISTICSMODE_TRACE) { return; }
+
+    printf("\n");
+
+    for (unsigned i = 0; i < State.ItemCount; i++)
+    {
+        const unsigned long long size = State.Items[i].Size;
+        const unsigned long long stored = AcquireArchiveItemStoredSize(i);
+
+        printf("%d %s %llu->%llu %.1f%%\n", State.Items[i].Type, State.Items[i].Name,
+            size, stored, size == 0 ? 100.0 : 100.0 * (double)stored / (double)size);
+    }
+}
\ No newline at end of file